@@ -1,19 +1,38 @@
 /*
 ================================================================================
 File: include/ai_engine.h
-Purpose: Declares the AIEngine class. This stable version uses the minimax
-         algorithm and passes the game state by reference to prevent crashes.
+Purpose: Declares the AIEngine class. The default search is an alpha-beta
+         negamax with move ordering, run by iterative deepening under a
+         per-move time budget; the original full-width minimax is kept as a
+         reference mode so the two can be compared in the benchmark.
 ================================================================================
 */
 #ifndef AI_ENGINE_H
 #define AI_ENGINE_H
 
 #include "game_logic.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 class AIEngine {
 public:
+    // Selects which tree search the HARD difficulty uses.
+    enum SearchMode {
+        MINIMAX,    // Full-width minimax, no pruning (reference implementation).
+        ALPHA_BETA  // Negamax with alpha-beta pruning and move ordering.
+    };
+
+    static constexpr std::chrono::milliseconds kDefaultTimeBudget{1000};
+
     AIEngine();
+    ~AIEngine();
 
     // The main function called by the GUI to get the AI's next move.
     Move getBestMove(GameLogic& game);
@@ -21,19 +40,130 @@ public:
     // Allows the GUI to change the AI's difficulty.
     void setDifficulty(int level);
 
+    void setSearchMode(SearchMode mode);
+    SearchMode getSearchMode() const;
+
+    // Number of positions visited by the most recent getBestMove call.
+    long long getLastNodeCount() const;
+
+    // --- Time Budget ---
+    // HARD deepens one ply at a time until the budget runs out and then plays
+    // the best move of the deepest finished iteration, so getBestMove takes
+    // at most about this long. 0 means no limit.
+    void setTimeBudget(std::chrono::milliseconds budget);
+    std::chrono::milliseconds getTimeBudget() const;
+    // Depth of the deepest iteration the last alpha-beta search finished.
+    int getLastSearchDepth() const;
+    // Stops deepening after this many plies (0 = no limit). With no time
+    // budget this gives repeatable fixed-depth searches for benchmarking.
+    void setDepthLimit(int plies);
+
+    // --- Parallel Search ---
+    // With more than one thread, each deepening iteration on boards larger
+    // than 3x3 shares its root moves among the threads, which all use the
+    // same (lock-free) transposition table. The default is 1 (serial).
+    void setThreadCount(int count);
+    int getThreadCount() const;
+
+    // --- Transposition Table ---
+    // The table lives as long as the engine, so results from one getBestMove
+    // call are reused by the next one in the same session.
+    void setUseTranspositionTable(bool enabled);
+    void setTranspositionTableSize(std::size_t entryCount);
+    // Also empties the canonical best-move cache.
+    void clearTranspositionTable();
+    TranspositionTable::Stats getTranspositionStats() const;
+    void resetTranspositionStats();
+
+    // --- Symmetry Reduction ---
+    // When enabled, positions are cached under their canonical orientation
+    // (see board_symmetry.h), so all 8 rotations/mirrors share one entry.
+    void setUseSymmetry(bool enabled);
+
+    // Boards other than 3x3 are too big to solve. There, HARD only considers
+    // cells next to a stone and scores the positions at the search horizon
+    // by their open lines (see evaluate). MINIMAX mode, symmetry and the
+    // lookup table only apply to 3x3.
+
+    // --- Perfect-Play Table ---
+    // When enabled (the default), HARD answers from the build-time generated
+    // table in perfect_play.h without searching. Disable it to force a search.
+    void setUseLookupTable(bool enabled);
+
+    // --- Cancellation ---
+    // While the flag is set, a running search unwinds as fast as it can and
+    // getBestMove returns {-1, -1}. Unfinished results are never cached.
+    // Pass nullptr to detach. The flag must outlive the search.
+    void setStopFlag(const std::atomic<bool>* flag);
+
 private:
     // Defines the different difficulty levels for the AI.
     enum Difficulty {
         EASY,
         HARD
     };
+    // Per-thread search state. Threads only share the table and the flags.
+    struct SearchThread {
+        long long nodes = 0;
+        bool aborted = false;
+    };
+
     Difficulty currentDifficulty;
+    SearchMode searchMode;
+    long long nodeCount;
+    bool useTranspositionTable;
+    TranspositionTable transpositionTable;
+    bool useSymmetry;
+    bool useLookupTable;
+    const std::atomic<bool>* stopFlag;
+    std::chrono::milliseconds timeBudget;
+    std::chrono::steady_clock::time_point deadline;
+    bool hasDeadline;
+    std::atomic<bool> timeUp;
+    int lastSearchDepth;
+    int depthLimit;
+    int threadCount;
+    std::unique_ptr<ThreadPool> threadPool;
+    // Best move per canonical position, stored in canonical orientation.
+    std::unordered_map<std::uint32_t, std::int8_t> canonicalMoveCache;
+    // Cells of a cellOrderBoardSize board, nearest the centre first.
+    std::vector<int> cellOrder;
+    int cellOrderBoardSize;
 
     // --- Minimax Algorithm Helpers ---
     Move findBestMove(GameLogic& game);
 
     // The minimax function now takes the game state by reference.
-    int minimax(GameLogic& game, bool isMaximizing);
+    int minimax(SearchThread& thread, GameLogic& game, bool isMaximizing);
+
+    // --- Alpha-Beta (Negamax) Helpers ---
+    Move findBestMoveAlphaBeta(GameLogic& game);
+
+    // One iteration of the deepening loop: searches every root move to
+    // 'depth'. Returns false if the search was stopped before it finished.
+    bool searchRoot(std::vector<SearchThread>& threads, GameLogic& game, int depth, int firstCell,
+                    Move& bestMove, int& bestScore);
+
+    // Returns the score from the point of view of the player to move,
+    // searching at most 'depth' more plies.
+    int negamax(SearchThread& thread, GameLogic& game, int depth, int alpha, int beta);
+
+    // Fills 'moves' with the legal moves worth searching, best guesses first.
+    // 'firstCell' (if >= 0) is placed at the front, e.g. the table's move.
+    void orderMoves(const GameLogic& game, int firstCell, MoveList& moves);
+    void buildCellOrder(int boardSize);
+
+    // Static score of a position nobody has won yet, for the side to move:
+    // every window of winLength cells that only one player occupies counts
+    // for that player, more the fuller it is. Always well inside +-kWinScore.
+    int evaluate(const GameLogic& game) const;
+
+    // True once the stop flag is raised or the deadline has passed.
+    bool stopRequested(SearchThread& thread);
+
+    // Table key for the position. With symmetry on, 'transform' is set to the
+    // transform that maps the real board onto its canonical orientation.
+    std::uint64_t positionKey(const GameLogic& game, int& transform) const;
 };
 
 #endif // AI_ENGINE_H
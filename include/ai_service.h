@@ -0,0 +1,63 @@
+/*
+================================================================================
+File: include/ai_service.h
+Purpose: Declares AIService, which runs AIEngine searches on a dedicated
+         worker thread so the Qt event loop never blocks on the AI. Each
+         request searches a private copy of the board, and the answer comes
+         back to the GUI thread through the queued moveReady signal. A newer
+         request or an explicit cancel() stops any search still running.
+================================================================================
+*/
+#ifndef AI_SERVICE_H
+#define AI_SERVICE_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include <memory>
+
+#include "ai_engine.h"
+#include "game_logic.h"
+
+class AIService : public QObject {
+    Q_OBJECT
+
+public:
+    // What the result will be used for; passed back unchanged in moveReady.
+    enum RequestKind {
+        AI_MOVE,
+        HINT
+    };
+
+    explicit AIService(QObject* parent = nullptr);
+    ~AIService();
+
+    // Queues a search on a snapshot of 'game' and returns its request id.
+    // Any search that is still pending or running is cancelled first.
+    int requestMove(const GameLogic& game, RequestKind kind);
+
+    // Stops the current search, if any. Its result will never be delivered.
+    void cancel();
+
+    // Applied on the worker thread before the next queued search starts.
+    void setDifficulty(int level);
+    void setTimeBudget(int milliseconds);
+
+    // True from requestMove until the matching moveReady (or cancel).
+    bool isBusy() const;
+
+signals:
+    // Emitted on the GUI thread. row/col are -1 if there was no legal move.
+    void moveReady(int requestId, int kind, int row, int col);
+
+private:
+    QThread workerThread;
+    QObject* workerContext;   // Lives on workerThread; queued work runs there.
+    AIEngine engine;          // Only ever touched from workerThread.
+
+    std::shared_ptr<std::atomic<bool>> activeStopFlag;
+    int nextRequestId;
+    int activeRequestId;
+};
+
+#endif // AI_SERVICE_H
@@ -0,0 +1,124 @@
+/*
+================================================================================
+File: include/board_symmetry.h
+Purpose: The eight symmetries of the 3x3 board (4 rotations x optional
+         mirror). A position and its rotated/mirrored copies have the same
+         value, so the AI maps every position to one canonical
+         representative, the smallest encoding among its 8 images, and
+         caches results under that.
+         All tables are built at compile time, so transforming a bitboard
+         costs a single array lookup.
+================================================================================
+*/
+#ifndef BOARD_SYMMETRY_H
+#define BOARD_SYMMETRY_H
+
+#include "game_logic.h"
+#include <array>
+#include <cstdint>
+
+namespace symmetry {
+
+constexpr int kTransformCount = 8;
+constexpr int kMaskCount = 1 << GameLogic::kClassicCellCount;
+
+using CellMap = std::array<std::array<std::int8_t, GameLogic::kClassicCellCount>, kTransformCount>;
+
+// cellMap[t][i] is where the stone on cell i ends up under transform t.
+constexpr CellMap buildCellMap() {
+    CellMap map{};
+    constexpr int n = GameLogic::kClassicBoardSize - 1;
+    for (int r = 0; r <= n; ++r) {
+        for (int c = 0; c <= n; ++c) {
+            const int images[kTransformCount][2] = {
+                {r, c},         // identity
+                {c, n - r},     // rotate 90
+                {n - r, n - c}, // rotate 180
+                {n - c, r},     // rotate 270
+                {r, n - c},     // mirror left/right
+                {n - r, c},     // mirror top/bottom
+                {c, r},         // main diagonal
+                {n - c, n - r}  // anti-diagonal
+            };
+            for (int t = 0; t < kTransformCount; ++t) {
+                map[t][GameLogic::cellIndex(r, c)] =
+                    static_cast<std::int8_t>(GameLogic::cellIndex(images[t][0], images[t][1]));
+            }
+        }
+    }
+    return map;
+}
+
+constexpr CellMap buildInverseCellMap(const CellMap& forward) {
+    CellMap inverse{};
+    for (int t = 0; t < kTransformCount; ++t) {
+        for (int i = 0; i < GameLogic::kClassicCellCount; ++i) {
+            inverse[t][forward[t][i]] = static_cast<std::int8_t>(i);
+        }
+    }
+    return inverse;
+}
+
+using MaskTable = std::array<std::array<Bitboard, kMaskCount>, kTransformCount>;
+
+constexpr MaskTable buildMaskTable(const CellMap& map) {
+    // Each mask's image is the image of the mask without its highest bit plus
+    // that bit's image. That keeps the compile-time cost to one step per entry.
+    MaskTable table{};
+    for (int t = 0; t < kTransformCount; ++t) {
+        int top = -1;
+        for (int bits = 1; bits < kMaskCount; ++bits) {
+            if ((bits & (bits - 1)) == 0) ++top;
+            table[t][bits] = static_cast<Bitboard>(table[t][bits ^ (1 << top)] | (1 << map[t][top]));
+        }
+    }
+    return table;
+}
+
+inline constexpr CellMap kCellMap = buildCellMap();
+inline constexpr CellMap kInverseCellMap = buildInverseCellMap(kCellMap);
+inline constexpr MaskTable kMaskTable = buildMaskTable(kCellMap);
+
+constexpr Bitboard transformBits(Bitboard bits, int transform) {
+    return kMaskTable[transform][bits];
+}
+
+// Maps a cell of the real board into the transformed board, and back.
+constexpr int transformCell(int cell, int transform) {
+    return kCellMap[transform][cell];
+}
+
+constexpr int inverseCell(int cell, int transform) {
+    return kInverseCellMap[transform][cell];
+}
+
+struct Canonical {
+    std::uint32_t key;  // X bits in the low 9 bits, O bits in the next 9.
+    int transform;      // The transform that produced this key.
+};
+
+// Returns the smallest encoding among the position's 8 images.
+constexpr Canonical canonicalize(Bitboard xBits, Bitboard oBits) {
+    Canonical best{~std::uint32_t(0), 0};
+    for (int t = 0; t < kTransformCount; ++t) {
+        std::uint32_t key = transformBits(xBits, t) |
+                            (std::uint32_t(transformBits(oBits, t)) << GameLogic::kClassicCellCount);
+        if (key < best.key) {
+            best.key = key;
+            best.transform = t;
+        }
+    }
+    return best;
+}
+
+// Spreads the 18-bit canonical key over 64 bits so it can index a hash table.
+constexpr std::uint64_t hashKey(std::uint32_t canonicalKey) {
+    std::uint64_t k = canonicalKey + 0x9E3779B97F4A7C15ull;
+    k = (k ^ (k >> 30)) * 0xBF58476D1CE4E5B9ull;
+    k = (k ^ (k >> 27)) * 0x94D049BB133111EBull;
+    return k ^ (k >> 31);
+}
+
+} // namespace symmetry
+
+#endif // BOARD_SYMMETRY_H
@@ -0,0 +1,85 @@
+/*
+================================================================================
+File: include/compact_game_store.h
+Purpose: Declares CompactGameStore, a struct-of-arrays container that holds
+         a game history in a few bytes per field instead of one GameState
+         (five strings and a move vector) per game:
+
+           game id     64-bit key: "game-" plus up to 15 hex digits is
+                       packed into the key itself; any other id is
+                       interned and the key is its table index
+           players     32-bit indexes into a table of interned strings
+           timestamp   seconds since the epoch for "YYYY-MM-DD HH:MM:SS";
+                       anything else is interned
+           moves       packed like the binary game log (4-bit cells on
+                       boards of up to 16 cells, a byte per cell above
+                       that) into an inline 8-byte buffer; longer games
+                       spill into a shared byte arena
+
+         Each field is its own column, so a scan over one field (say, a
+         player's slots) reads only that column. Games are copied out as
+         GameState on demand. Moves must lie on the board, as for the
+         binary log (see record_format.h).
+================================================================================
+*/
+#ifndef COMPACT_GAME_STORE_H
+#define COMPACT_GAME_STORE_H
+
+#include "game_logic.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class CompactGameStore {
+public:
+    std::size_t size() const { return ids.size(); }
+    void clear();
+    void reserve(std::size_t games);
+
+    // Adds a game at the end and returns its slot.
+    std::size_t append(const GameState& game);
+    void replace(std::size_t slot, const GameState& game);
+    void get(std::size_t slot, GameState& game) const;
+
+    // Keys stand in for a game id or player id without its string. Each
+    // find returns false if no game in the store could have that id.
+    std::uint64_t gameKey(std::size_t slot) const { return ids[slot]; }
+    bool findGameKey(const std::string& gameId, std::uint64_t& key) const;
+    std::uint32_t player1Key(std::size_t slot) const { return player1[slot]; }
+    std::uint32_t player2Key(std::size_t slot) const { return player2[slot]; }
+    bool findPlayerKey(const std::string& playerId, std::uint32_t& key) const;
+
+    // Bytes allocated for the columns, the move arena and the string table
+    // (not counting allocator overhead).
+    std::size_t memoryBytes() const;
+    // Bytes a string has allocated beyond its own object; none while it
+    // fits in its inline buffer.
+    static std::size_t heapBytes(const std::string& text);
+
+private:
+    void store(std::size_t slot, const GameState& game);
+    std::uint32_t intern(const std::string& text);
+
+    // One entry per game in each column.
+    std::vector<std::uint64_t> ids;
+    std::vector<std::uint32_t> player1;
+    std::vector<std::uint32_t> player2;
+    // Epoch seconds, or a string index if kTextTimestamp is set.
+    std::vector<std::int64_t> times;
+    std::vector<std::int32_t> durations;
+    // Packed cells, or an offset into 'moveArena' if kSpilledMoves is set.
+    std::vector<std::uint64_t> moveData;
+    std::vector<std::uint8_t> moveCounts;
+    std::vector<std::uint8_t> boardSizes;
+    std::vector<std::uint8_t> winLengths;
+    // Result in the low two bits, then the flags below.
+    std::vector<std::uint8_t> flags;
+
+    std::string moveArena;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, std::uint32_t> stringIndex;
+};
+
+#endif // COMPACT_GAME_STORE_H
@@ -2,30 +2,120 @@
 #ifndef DATABASE_MANAGER_H
 #define DATABASE_MANAGER_H
 
+#include "storage_backend.h"
 #include "user_auth.h"
 #include "game_history.h"
+#include <cstddef>
 #include <string>
 #include <vector>
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <QStandardPaths>
 
-class DatabaseManager {
+class MappedGameLog;
+class ThreadPool;
+
+// The flat-file storage backend: users and games in files next to
+// dbFilePath (.users, .games), in the text or binary layout.
+class DatabaseManager : public StorageBackend {
 public:
     DatabaseManager(std::string dbFilePath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation).toStdString() + "/tictactoe_data.db");
-    ~DatabaseManager();
+    ~DatabaseManager() override;
+
+    // True if either file exists.
+    bool hasFiles() const;
+
+    // On-disk layout used when writing. Both layouts can always be read; a
+    // file found in the other one is converted the next time it is loaded.
+    // Binary is the default (see record_format.h).
+    enum class StorageFormat { Text, Binary };
+    void setStorageFormat(StorageFormat format) {
+        storageFormat = format;
+        userIndexLoaded = false;
+    }
+    StorageFormat getStorageFormat() const { return storageFormat; }
+
+    // When true (the default), writes are fsynced before they return: whole
+    // files are replaced atomically, and game appends and user journal
+    // entries survive a crash.
+    void setSyncWrites(bool sync) override { syncWrites = sync; }
+    bool getSyncWrites() const { return syncWrites; }
+
+    // A read-only manager never changes its files. Loads return the same
+    // data but leave migrations, journal replays, torn tails and dead
+    // records on disk as they found them, and every write fails. Used to
+    // import the files into another backend.
+    void setReadOnly(bool readOnly) { this->readOnly = readOnly; }
 
     // User data management
-    bool saveUsers(const std::unordered_map<std::string, UserProfile>& users);
-    std::unordered_map<std::string, UserProfile> loadUsers();
-    bool saveUser(const UserProfile& user);
+    //
+    // One record per user whose stats have a fixed width, located through an
+    // index built on load, so saveUser rewrites a single record in place.
+    // Each update is first appended to a write-ahead journal (.users.wal),
+    // which loadUsers replays.
+    bool saveUsers(const std::unordered_map<std::string, UserProfile>& users) override;
+    std::unordered_map<std::string, UserProfile> loadUsers() override;
+    bool saveUser(const UserProfile& user) override;
+    bool loadUser(const std::string& userId, UserProfile& user) override;
 
     // Game history management
-    bool saveGameHistory(const std::vector<GameState>& games);
-    std::vector<GameState> loadGameHistory();
+    //
+    // Games live in an append-only log of checksummed records, so saving a
+    // game costs the same whether the history holds ten games or a hundred
+    // thousand. A record cut short by a crash mid-append fails its checksum;
+    // loadGameHistory drops it and trims it off the file.
+    // Appends all the games with a single write.
+    bool appendGames(const std::vector<GameState>& games) override;
+    // Large logs are split at record boundaries and the pieces parsed on
+    // a thread pool, then merged in file order.
+    std::vector<GameState> loadGameHistory() override;
+    // Reads the log in fixed-size chunks. Unlike loadGameHistory it can't
+    // know whether a later record supersedes a game, so a game saved twice
+    // is visited twice; torn and corrupt records are skipped, and the file
+    // is never modified.
+    // Safe to call while another thread writes games: it reads through its
+    // own file handle and no member the writes change. An append is added
+    // to the end of the log, so a read that meets it part-way sees a torn
+    // tail and stops there. A rewrite replaces the file by rename, so a
+    // read already under way keeps reading the old file.
+    void forEachGame(const std::function<bool(const GameState&)>& visit) override;
+    // Zero-copy alternative to loadGameHistory for the binary format: maps
+    // the log and decodes records only when they are read. Returns null if
+    // there is no history or the text format is selected. Rewriting or
+    // trimming the log later closes the mapping and reopens it on the new
+    // file (see MappedGameLog::reopen).
+    std::shared_ptr<const MappedGameLog> mapGameHistory() override;
+    // Replaces the whole log with exactly these games (atomically).
+    bool saveGameHistory(const std::vector<GameState>& games) override;
+    // Rewrites the log with only its live records. loadGameHistory does this
+    // on its own once dead records make up a large share of the file.
+    bool compactGameLog();
+
+    // Not indexed: each of these loads the whole history.
+    std::vector<GameState> loadUserGames(const std::string& userId) override;
+    bool loadGame(const std::string& gameId, GameState& game) override;
+    std::size_t countGames() override;
 
-    // The single saveGame function below has been removed to simplify the data flow
-    // and fix the bug. The GUI will now manage saving via saveGameHistory.
+    // Saves each user in place, then appends the games.
+    bool writeBatch(const std::unordered_map<std::string, UserProfile>& users,
+                    const std::vector<GameState>& games) override;
+
+    // Threads loadGameHistory parses with (at least 1; defaults to the
+    // number of cores). Logs under a megabyte are always parsed on the
+    // calling thread.
+    void setLoadThreads(int threads);
+    int getLoadThreads() const { return loadThreads; }
+
+    struct GameLogStats {
+        std::size_t liveRecords = 0;
+        // Superseded, corrupt, or legacy (unchecksummed) records.
+        std::size_t deadRecords = 0;
+        // Bytes of torn tail cut off by the last load.
+        std::size_t truncatedBytes = 0;
+    };
+    GameLogStats getGameLogStats() const { return gameLogStats; }
 
 private:
     std::string db_file_path_;
@@ -37,9 +127,62 @@ private:
     // Serialization helpers
     std::string serializeUsers(const std::unordered_map<std::string, UserProfile>& users);
     std::unordered_map<std::string, UserProfile> deserializeUsers(const std::string& data);
+    std::string serializeUser(const UserProfile& user);
+
+    // Byte range of each user's record in the .users file.
+    struct UserRecordLocation {
+        std::streamoff offset;
+        std::size_t length;
+    };
+    std::unordered_map<std::string, UserRecordLocation> userIndex;
+    // False until the index matches the file (and the file is fixed-width).
+    bool userIndexLoaded = false;
+    std::string usersFilePath() const;
+    std::string userJournalPath() const;
+    bool writeUserRecord(const UserProfile& user);
+    // Applies intact journal entries to 'users'; returns how many.
+    std::size_t replayUserJournal(std::unordered_map<std::string, UserProfile>& users);
+
+    // Game log helpers
+    std::string gamesFilePath() const;
+    StorageFormat fileFormat(const std::string& path, const char (&magic)[4]) const;
+    std::string serializeGame(const GameState& game);
+    // Checks a text record's checksum, strips it, and parses the game.
+    bool parseRecordLine(std::string& line, GameState& game, bool& legacy);
+    bool parseGame(const std::string& line, GameState& game);
+
+    // The records parsed from one piece of the game log, in file order.
+    struct ParsedChunk {
+        std::vector<GameState> games;
+        // Corrupt and legacy records (legacy ones are also in 'games').
+        std::size_t deadRecords = 0;
+        // Offset just past the last intact record, or 0 if there was none.
+        std::size_t validEnd = 0;
+    };
+    // Splits data[begin, end) into pieces that start on record boundaries
+    // and parses them in parallel when the log is large enough.
+    std::vector<ParsedChunk> parseGameLog(const std::string& data, std::size_t begin, std::size_t end, bool binary);
+    void parseTextChunk(const std::string& data, std::size_t begin, std::size_t end, ParsedChunk& chunk);
+    // Parses the records that start in [begin, end); the last may run past
+    // 'end'. Unless 'aligned', 'begin' need not be a record boundary.
+    void parseBinaryChunk(const std::string& data, std::size_t begin, std::size_t end, bool aligned,
+                          ParsedChunk& chunk);
+
+    // The mappings mapGameHistory handed out that are still in use. A file
+    // that is mapped can't be replaced or resized on Windows, so they are
+    // closed around each change to the log and reopened after it.
+    std::mutex mappingsMutex;
+    std::vector<std::weak_ptr<MappedGameLog>> mappings;
+    std::vector<std::shared_ptr<MappedGameLog>> closeMappings();
+    void reopenMappings(const std::vector<std::shared_ptr<MappedGameLog>>& closed);
 
-    std::string serializeGames(const std::vector<GameState>& games);
-    std::vector<GameState> deserializeGames(const std::string& data);
+    GameLogStats gameLogStats;
+    StorageFormat storageFormat = StorageFormat::Binary;
+    bool syncWrites = true;
+    bool readOnly = false;
+    int loadThreads;
+    // Created on the first load that uses more than one thread.
+    std::unique_ptr<ThreadPool> loadPool;
 };
 
 #endif // DATABASE_MANAGER_H
@@ -0,0 +1,30 @@
+/*
+================================================================================
+File: include/durable_file.h
+Purpose: Crash-safe file primitives for the storage layer. writeAtomically
+         writes a temp file next to the target, fsyncs it, renames it over
+         the target and fsyncs the directory, so after a crash the file holds
+         either its old or its new contents, never a mix. append fsyncs
+         before returning, so appended records survive a crash once the
+         call returns. Passing sync = false skips the fsyncs but keeps the
+         rename, which is useful for tests and for measuring durability cost.
+         If the rename fails (on Windows, while the target is open or
+         mapped elsewhere) the temp file is removed, the target keeps its
+         old contents, and the error is printed.
+================================================================================
+*/
+#ifndef DURABLE_FILE_H
+#define DURABLE_FILE_H
+
+#include <string>
+
+namespace durable_file {
+
+bool writeAtomically(const std::string& path, const std::string& data, bool sync = true);
+bool append(const std::string& path, const std::string& data, bool sync = true);
+// Flushes an existing file's contents to disk.
+bool sync(const std::string& path);
+
+} // namespace durable_file
+
+#endif // DURABLE_FILE_H
@@ -2,38 +2,194 @@
 #ifndef GAME_HISTORY_H
 #define GAME_HISTORY_H
 
+#include "compact_game_store.h"
 #include "game_logic.h"
+#include "replay_cursor.h"
 #include <vector>
 #include <string>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <ctime>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
-// Forward-declare DatabaseManager to avoid circular dependencies.
-class DatabaseManager;
+class MappedGameLog;
+class StorageBackend;
+
+// One user's games held by a GameHistory, oldest first. Shared with the
+// GameRanges over it.
+struct UserGameList {
+    std::vector<const GameState*> games;
+    // Bumped by every change except adding a game at the newest end, and
+    // when the games it points to go away (the history is loaded again or
+    // destroyed).
+    std::uint64_t generation = 0;
+};
+
+// A newest-first view of one user's games held by a GameHistory. It covers
+// the games the user had when it was made, so it stays valid while games
+// are saved after them. Any other change to the user's list, or loading
+// the history again, invalidates it, and an invalid range is empty; it
+// never points at games that have gone.
+class GameRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = GameState;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const GameState*;
+        using reference = const GameState&;
+
+        explicit iterator(const UserGameList* list = nullptr, std::size_t position = 0)
+            : list(list), position(position) {}
+        reference operator*() const { return *list->games[position - 1]; }
+        pointer operator->() const { return list->games[position - 1]; }
+        iterator& operator++() { --position; return *this; }
+        iterator operator++(int) { iterator old = *this; --position; return old; }
+        bool operator==(const iterator& other) const { return position == other.position; }
+        bool operator!=(const iterator& other) const { return position != other.position; }
+
+    private:
+        const UserGameList* list;
+        // One past the game it refers to; the view runs backwards.
+        std::size_t position;
+    };
+
+    GameRange() = default;
+    // The first 'count' games of 'list'.
+    GameRange(std::shared_ptr<const UserGameList> list, std::size_t count)
+        : list(std::move(list)), count(count), generation(this->list->generation) {}
+
+    bool isValid() const { return !list || list->generation == generation; }
+    iterator begin() const { return iterator(list.get(), size()); }
+    iterator end() const { return iterator(list.get(), 0); }
+    std::size_t size() const { return isValid() ? count : 0; }
+    bool empty() const { return size() == 0; }
+    // Index 0 is the newest game; 'index' must be below size().
+    const GameState& operator[](std::size_t index) const { return *list->games[count - 1 - index]; }
+    const GameState& front() const { return (*this)[0]; }
+
+private:
+    std::shared_ptr<const UserGameList> list;
+    std::size_t count = 0;
+    std::uint64_t generation = 0;
+};
 
 class GameHistory {
 public:
     GameHistory();
+    ~GameHistory();
+
+    GameHistory(const GameHistory&) = delete;
+    GameHistory& operator=(const GameHistory&) = delete;
 
     // MODIFIED: saveGame now only updates the in-memory list and no longer needs a DatabaseManager reference.
+    // boardSize/winLength record which variant was played (3x3 by default).
     std::string saveGame(const std::string& player1Id, const std::string& player2Id,
                  bool isAIOpponent, const std::vector<Move>& moves,
-                 GameResult result);
+                 GameResult result, int boardSize = GameLogic::kClassicBoardSize,
+                 int winLength = GameLogic::kClassicBoardSize);
 
-    // NEW: This function provides access to the full history list for saving.
-    const std::vector<GameState>& getAllGames() const;
+    // Games saved since the history was loaded; games loaded from disk are
+    // read from the archive on demand.
+    const std::deque<GameState>& getRecentGames() const;
+    std::size_t getGameCount() const;
 
     // Retrieve game records
-    std::vector<GameState> getUserGames(const std::string& userId);
-    GameState getGameById(const std::string& gameId);
+    //
+    // A user's games, newest first, from a per-user index kept in time
+    // order as games are saved or loaded, so a lookup costs the number of
+    // games returned. A user's games that are only on disk are brought in
+    // (and indexed) by their first lookup, which reads just their records:
+    // loadFromDatabase's pass notes which records each user played in.
+    GameRange getUserGames(const std::string& userId);
+    // The game with this id, or null if there is none. Held games are found
+    // through a hash index without copying; a game only on disk is brought
+    // in by its first lookup, which finds its record through an index of
+    // the ids on disk. Valid until the history is next loaded.
+    const GameState* getGameById(const std::string& gameId);
 
-    void loadFromDatabase(DatabaseManager& dbManager);
+    // Backends with indexed lookups (see storage_backend.h) are queried per
+    // lookup; nothing is loaded up front. With the binary log the file is
+    // memory-mapped, and loading only reads each record's ids in place to
+    // index them; a game is decoded when a lookup reaches it. Otherwise the
+    // history is streamed once and only the newest 'eagerGames' are kept
+    // in memory, packed in a CompactGameStore; lookups that need older
+    // games stream it again, up to the record they need. Unless everything fit in memory, the backend must
+    // outlive this history.
+    static constexpr std::size_t kDefaultEagerGames = 1000;
+    void loadFromDatabase(StorageBackend& storage, std::size_t eagerGames = kDefaultEagerGames);
 
     // Replay functionality
+    //
+    // A playable GameLogic after the first moveIndex moves (all of them by
+    // default). Each call replays from the start; to scrub back and forth
+    // through a game, open a ReplayCursor instead.
     GameLogic replayGame(const std::string& gameId, int moveIndex = -1);
+    // A cursor over the game's positions, or an empty one if there is no
+    // such game.
+    ReplayCursor openReplay(const std::string& gameId);
 
 private:
-    std::vector<GameState> gameHistory;
+    std::shared_ptr<const MappedGameLog> archive;
+    // Set instead of 'archive' for backends with indexed lookups.
+    StorageBackend* database = nullptr;
+    // Stored games a lookup has brought in, from any backend. Lookups hand
+    // out references to these, so they are full GameStates.
+    std::deque<GameState> loadedGames;
+    // Without 'archive' or 'database': the newest stored games, packed,
+    // which start at stream position 'firstEager', and the backend to
+    // stream the older ones from if there are any. A game is copied out of
+    // 'eagerStore' into 'loadedGames' when a lookup first reaches it.
+    CompactGameStore eagerStore;
+    std::size_t firstEager = 0;
+    StorageBackend* olderGames = nullptr;
+    std::size_t storedGameCount = 0;
+    std::deque<GameState> gameHistory;
+
+    // Every game in 'loadedGames' and 'gameHistory' by id, and each user's
+    // games oldest first. Deques never move their elements, so the
+    // pointers stay valid until the history is loaded again.
+    std::unordered_map<std::string, const GameState*> gamesById;
+    std::unordered_map<std::string, std::shared_ptr<UserGameList>> gamesByUser;
+    // Users whose games on disk have been brought into 'loadedGames'.
+    std::unordered_set<std::string> fetchedUsers;
+    // The stored records each user played in that aren't held yet, in
+    // record order: record numbers in 'archive', or stream positions (in
+    // 'eagerStore' from 'firstEager' on). Built by loadFromDatabase's pass
+    // (again if the archive is rewritten); a user's entry goes once they
+    // are fetched.
+    std::unordered_map<std::string, std::vector<std::uint32_t>> storedByUser;
+    // One entry per stored game, so an id lookup goes straight to the
+    // record or knows there is none: the high 32 bits hash the id, the low
+    // 32 are its record number in 'archive' or its stream position. Sorted,
+    // so a lookup is a binary search and the whole index is 8 bytes per
+    // stored game. Hashes can collide; a candidate's id is checked when it
+    // is read. Built by the same pass as 'storedByUser'.
+    std::vector<std::uint64_t> storedIds;
+    // The archive's generation the record numbers above belong to.
+    bool archiveIndexed = false;
+    std::uint64_t archiveGeneration = 0;
+    // Indexes a game under its id and both players, replacing any earlier
+    // game with the same id.
+    void indexGame(const GameState& game);
+    void indexUserGame(const std::string& userId, const GameState& game);
+    // Empties every user's list and invalidates the ranges over them.
+    void dropUserGames();
+    void indexStoredRecord(std::string_view player1Id, std::string_view player2Id, std::size_t record);
+    // Builds 'storedByUser' and 'storedIds' for the archive in one pass
+    // over its records, unless they are up to date.
+    void indexArchive();
+    void fetchStoredGames(const std::string& userId);
+    static std::uint64_t storedIdEntry(std::string_view gameId, std::size_t record);
+    // Reads the newest record of a game on disk through 'storedIds'.
+    bool loadStoredGame(const std::string& gameId, GameState& game);
 
     std::string generateGameId();
     std::string getCurrentTimestamp();
@@ -0,0 +1,76 @@
+/*
+================================================================================
+File: include/game_history_model.h
+Purpose: Declares GameHistoryModel, the table model behind the history view.
+         It reads a user's games straight from GameHistory's per-user index
+         (a GameRange) rather than copying each one into widget items, and
+         hands rows to the view a batch at a time through canFetchMore and
+         fetchMore, so showing the view costs the same for ten games as for
+         a million. Sorting and filtering happen in the model; sorting by
+         date is free, since the index is already in time order.
+================================================================================
+*/
+#ifndef GAME_HISTORY_MODEL_H
+#define GAME_HISTORY_MODEL_H
+
+#include <QAbstractTableModel>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "game_history.h"
+
+class GameHistoryModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column { DateColumn, OpponentColumn, ResultColumn, MovesColumn, ColumnCount };
+    // Holds the game id on every column of a row.
+    static constexpr int GameIdRole = Qt::UserRole;
+    // Rows handed to the view per fetchMore.
+    static constexpr int kFetchBatch = 200;
+
+    explicit GameHistoryModel(QObject* parent = nullptr);
+
+    // Shows these games. Call it again once the history has changed: a
+    // range stops yielding games when it becomes invalid (see GameRange),
+    // and rows already shown point into the history until it is reloaded.
+    void setGames(GameRange games);
+    // Shows only games whose opponent or result contains 'text', ignoring
+    // case. An empty filter shows every game.
+    void setFilterText(const QString& text);
+    // The game shown in this row, or null.
+    const GameState* gameAt(const QModelIndex& index) const;
+
+    static QString resultLabel(GameResult result);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+private:
+    // The n-th game in the current sort order, filtered or not.
+    const GameState* ordered(std::size_t n) const;
+    bool accepts(const GameState& game) const;
+    // Scans on from 'scanned' for up to a batch of games the filter accepts.
+    std::vector<const GameState*> nextBatch();
+    // Drops every row and fetches the first batch again.
+    void restart();
+
+    GameRange games;
+    int sortColumn = DateColumn;
+    Qt::SortOrder sortOrder = Qt::DescendingOrder;
+    // Only built when sorting by a column other than the date.
+    std::vector<const GameState*> sorted;
+    std::string filter;
+    // How far through the ordered games fetching has got, and the rows
+    // shown so far.
+    std::size_t scanned = 0;
+    std::vector<const GameState*> rows;
+};
+
+#endif // GAME_HISTORY_MODEL_H
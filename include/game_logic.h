@@ -3,6 +3,8 @@
 #define GAME_LOGIC_H
 
 #include <array>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -25,38 +27,159 @@ struct GameState {
     GameResult result;
     std::string timestamp;
     int durationSeconds = 0;
-    
+    int boardSize = 3;
+    int winLength = 3;
+
     GameState() : result(GameResult::IN_PROGRESS), isAIOpponent(false) {}
 };
 
+// One bit per cell of the classic 3x3 board, cell index = row * 3 + col.
+// Bit 0 is the top-left corner.
+using Bitboard = std::uint16_t;
+
+// One bit per cell for boards up to 16x16 (256 cells), same indexing as
+// Bitboard but with the row stride equal to the board size.
+class BoardMask {
+public:
+    static constexpr int kWordCount = 4;
+
+    bool test(int cell) const { return (words[cell >> 6] >> (cell & 63)) & 1u; }
+    void set(int cell) { words[cell >> 6] |= std::uint64_t(1) << (cell & 63); }
+    void reset(int cell) { words[cell >> 6] &= ~(std::uint64_t(1) << (cell & 63)); }
+    void clear() { words.fill(0); }
+
+    std::uint64_t word(int i) const { return words[i]; }
+
+    BoardMask operator|(const BoardMask& other) const {
+        BoardMask result;
+        for (int i = 0; i < kWordCount; ++i) result.words[i] = words[i] | other.words[i];
+        return result;
+    }
+
+private:
+    std::array<std::uint64_t, kWordCount> words{};
+};
+
+// A fixed-capacity list of moves that lives on the stack. The search code uses
+// it instead of std::vector so that generating moves never touches the heap.
+class MoveList {
+public:
+    static constexpr int kCapacity = 15 * 15;
+
+    void clear() { count = 0; }
+    void push(const Move& move) { moves[count++] = move; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    Move& operator[](int i) { return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+
+    Move* begin() { return moves.data(); }
+    Move* end() { return moves.data() + count; }
+    const Move* begin() const { return moves.data(); }
+    const Move* end() const { return moves.data() + count; }
+
+private:
+    std::array<Move, kCapacity> moves;
+    int count = 0;
+};
+
+// Every run of winLength cells ("line") on a board of a given size, and
+// which lines pass through each cell. Built once per board configuration and
+// shared by all GameLogic objects using it.
+struct LineTable {
+    int boardSize = 0;
+    int winLength = 0;
+    std::vector<std::int16_t> lineStart;  // First cell of each line.
+    std::vector<std::int16_t> lineStep;   // Cell index step along the line.
+    // Lines through cell c: cellLines[cellLineBegin[c] .. cellLineBegin[c + 1]).
+    std::vector<std::int32_t> cellLineBegin;
+    std::vector<std::int16_t> cellLines;
+
+    int lineCount() const { return static_cast<int>(lineStart.size()); }
+};
+
+// Rules for an N x N board where K stones in a row (horizontally, vertically
+// or diagonally) win. The default is classic 3x3 tic-tac-toe.
 class GameLogic {
 public:
-    GameLogic();
+    static constexpr int kClassicBoardSize = 3;
+    static constexpr int kClassicCellCount = kClassicBoardSize * kClassicBoardSize;
+    static constexpr int kMinBoardSize = 3;
+    static constexpr int kMaxBoardSize = 15;
+    static constexpr int kMaxCellCount = kMaxBoardSize * kMaxBoardSize;
+
+    static constexpr int cellIndex(int row, int col, int boardSize = kClassicBoardSize) {
+        return row * boardSize + col;
+    }
+
+    explicit GameLogic(int boardSize = kClassicBoardSize, int winLength = kClassicBoardSize);
+
+    // Changes the board geometry and starts a fresh game. Out-of-range values
+    // are clamped: size to [kMinBoardSize, kMaxBoardSize], winLength to [3, size].
+    void setBoardConfig(int boardSize, int winLength);
+    int getBoardSize() const { return boardSize; }
+    int getWinLength() const { return winLength; }
+    int getCellCount() const { return boardSize * boardSize; }
+    // True for the 3x3, three-in-a-row game the lookup tables are built for.
+    bool isClassic() const { return boardSize == kClassicBoardSize && winLength == kClassicBoardSize; }
 
     void resetBoard();
     bool makeMove(int row, int col);
     bool isValidMove(int row, int col) const;
+    // O(1): makeMove/undoLastMove keep per-line stone counts and the number
+    // of filled cells up to date, so the result is known after every move.
     GameResult checkGameResult() const;
     bool isBoardFull() const;
 
-    // NEW: This function will return the coordinates of the 3 winning cells.
+    // Returns the coordinates of the K cells that made the win, or an empty list.
     std::vector<Move> findWinningCombination() const;
 
     Player getCurrentPlayer() const;
     Player getCell(int row, int col) const;
     const std::vector<Move>& getMoveHistory() const;
     std::vector<Move> getAvailableMoves() const;
-    const std::array<std::array<Player, 3>, 3>& getBoard() const;
+    // Allocation-free variant for the AI search: fills a caller-owned list.
+    void getAvailableMoves(MoveList& moves) const;
+    // Builds a 2D view of the board (boardSize x boardSize).
+    std::vector<std::vector<Player>> getBoard() const;
+
+    // Raw bitboard access for search-heavy callers. getPlayerBits/
+    // getOccupiedBits hold the first 16 cells and are only meaningful for
+    // boards of up to 4x4; larger boards use getPlayerMask.
+    Bitboard getPlayerBits(Player player) const;
+    Bitboard getOccupiedBits() const;
+    const BoardMask& getPlayerMask(Player player) const;
+
+    // The board's lines, and how many stones 'player' has on each of them
+    // (indexed like the table's lines).
+    const LineTable& getLineTable() const { return *lines; }
+    const std::vector<std::uint8_t>& getLineCounts(Player player) const;
+
+    // Zobrist hash of the current position, maintained incrementally.
+    std::uint64_t getHashKey() const { return hashKey; }
 
     // Now public so the replay system can use it easily.
     void undoLastMove();
 
 private:
-    std::array<std::array<Player, 3>, 3> board;
+    int boardSize;
+    int winLength;
+    BoardMask xMask;
+    BoardMask oMask;
+    std::uint64_t hashKey;
     Player currentPlayer;
     std::vector<Move> moveHistory;
+    std::shared_ptr<const LineTable> lines;
+    std::vector<std::uint8_t> xLineCounts;
+    std::vector<std::uint8_t> oLineCounts;
+    int filledCells;
+    GameResult result;
+    // Number of moves on the board when the result was decided, or -1.
+    int decidedAtMove;
+    // The line that won the game, or -1.
+    int winningLine;
 
-    bool checkWin(Player player) const;
     void recordMove(int row, int col);
 };
-#endif // GAME_LOGIC_H
\ No newline at end of file
+#endif // GAME_LOGIC_H
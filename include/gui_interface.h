@@ -8,7 +8,7 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QStackedWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
 #include <QRadioButton>
 #include <QMessageBox>
@@ -33,17 +33,20 @@
 #include <QDir>
 #include <string>
 
-#include "database_manager.h"
+#include "storage_backend.h"
 #include "user_auth.h"
 #include "game_logic.h"
-#include "ai_engine.h"
+#include "ai_service.h"
 #include "game_history.h"
+#include "game_history_model.h"
+#include "replay_cursor.h"
+#include "persistence_writer.h"
 
 class GUIInterface : public QMainWindow {
     Q_OBJECT
 
 public:
-    explicit GUIInterface(const std::string& dbPath, QWidget *parent = nullptr);
+    explicit GUIInterface(std::unique_ptr<StorageBackend> storage, QWidget *parent = nullptr);
     ~GUIInterface();
 
 private slots:
@@ -58,9 +61,10 @@ private slots:
     void onGameModeChanged();
     void onThemeChanged(int id);
     void onAnimationSpeedChanged(int value);
+    void onAISpeedChanged(int value);
     void onViewHistoryClicked();
     void onViewStatsClicked();
-    void onGameHistoryItemClicked(QTableWidgetItem *item);
+    void onGameHistoryItemClicked(const QModelIndex& index);
     void onBackToGameClicked();
     void onReplayNextClicked();
     void onReplayPrevClicked();
@@ -68,13 +72,19 @@ private slots:
     void onReplayAutoPlay();
     void onGameTimerUpdate();
     void onExitReplayClicked();
+    void onAIMoveReady(int requestId, int kind, int row, int col);
 
 private:
-    DatabaseManager dbManager;
+    std::unique_ptr<StorageBackend> storage;
+    // All saves go through here, off the GUI thread. Declared after
+    // storage so it flushes and stops before the backend is destroyed.
+    std::unique_ptr<PersistenceWriter> persistence;
     UserAuth userAuth;
     GameLogic gameLogic;
-    AIEngine aiEngine;
-    GameHistory gameHistory;    
+    AIService* aiService;
+    GameHistory gameHistory;
+    int pendingAIMoveRequest;
+    int pendingHintRequest;
 
     enum Theme { DARK, LIGHT, NEON };
     Theme currentTheme;
@@ -89,15 +99,22 @@ private:
     QWidget *loginWidget, *gameWidget, *historyWidget, *statsWidget, *settingsWidget;
     QFrame *navigationFrame, *loginFrame, *welcomeFrame, *boardFrame, *scoreFrame, *controlsFrame, *historyHeader, *tableFrame, *historyDetailsFrame, *statsHeader, *statsFrame, *settingsContentFrame;
     QLineEdit *usernameInput, *passwordInput;
-    QPushButton *boardButtons[3][3];
+    // One button per cell, row-major; rebuilt when the board size changes.
+    std::vector<QPushButton*> boardButtons;
+    QGridLayout *boardLayout;
     QLabel *statusLabel, *timerLabel, *loginStatusLabel, *playerXScoreLabel, *playerOScoreLabel, *streakLabel, *winRateLabel, *totalGamesLabel, *winRateStatsLabel, *averageGameTimeLabel, *longestStreakLabel, *favoriteOpponentLabel, *replayPositionLabel;
     QProgressBar *aiThinkingBar, *loginProgressBar;
     QTabWidget *gameModeTab, *settingsTab;
     QWidget *pvpModeWidget, *aiModeWidget, *appearanceTab, *gameplayTab;
-    QComboBox *difficultyCombo;
+    QComboBox *difficultyCombo, *boardVariantCombo;
+    // Index of the variant on the board now; the combo can briefly differ
+    // while a switch waits for confirmation.
+    int activeBoardVariant = 0;
     QSlider *aiSpeedSlider, *animationSpeedSlider, *replaySpeedSlider;
     QPushButton *loginButton, *registerButton, *guestButton, *newGameButton, *undoButton, *hintButton, *pauseButton, *backToGameButton, *exportHistoryButton;
-    QTableWidget *gameHistoryTable;
+    QTableView *gameHistoryTable;
+    GameHistoryModel *gameHistoryModel;
+    QLineEdit *historyFilterInput;
     QSplitter *historySplitter;
     QTextEdit *gameDetailsText;
     QButtonGroup *themeGroup;
@@ -107,8 +124,8 @@ private:
     QPushButton *replayStartButton, *replayPrevButton, *replayNextButton, *replayAutoButton;
     QPushButton *gameNavButton, *historyNavButton, *statsNavButton, *settingsNavButton;
     QTimer *replayAutoTimer;
-    std::vector<Move> replayHistory;
-    int replayMoveIndex;
+    // The game being replayed, with its position after every move.
+    ReplayCursor replayCursor;
     bool replayAutoMode;
     QScrollArea *statsScrollArea;
 
@@ -124,17 +141,26 @@ private:
     void setupSettingsView();
     void setupReplayControls();
     void setupReplayControls(bool visible); // Overloaded version
+    QPushButton* cellButton(int row, int col) const;
+    void rebuildBoardButtons();
+    void setBoardButtonsEnabled(bool enabled);
+    // Switches gameLogic to the given geometry (starting a fresh board).
+    void applyBoardConfig(int boardSize, int winLength);
+    void applySelectedBoardVariant();
     void applyTheme(Theme theme);
     void updateButtonStyles();
     void animateButton(QWidget* widget);
     void addDropShadow(QWidget* widget);
     void addGlowEffect(QWidget* widget, const QColor& color);
     void updateBoard(bool isReplay = false);
+    // Draws one cell of the replay cursor's current position.
+    void showReplayCell(int row, int col);
     void updateScoreDisplay();
     void updateGameStats();
     void updateTimer();
     void handleGameOver(GameResult result);
     void makeAIMove();
+    void cancelAIRequests();
     void showHint();
     void highlightWinningCells(const std::vector<Move>& cells);
     void resetBoardHighlights();
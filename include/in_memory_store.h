@@ -0,0 +1,58 @@
+/*
+================================================================================
+File: include/in_memory_store.h
+Purpose: Declares InMemoryStore, a storage backend that keeps everything in
+         process memory and writes nothing to disk. Games are indexed by id
+         and by player, like the SQLite tables, so it shows what the
+         storage work costs with all I/O taken out. Games are held in a
+         CompactGameStore, a few dozen bytes each, and indexed by their
+         packed keys rather than by strings. One mutex guards all of it, so
+         a writer thread and readers can share a store.
+================================================================================
+*/
+#ifndef IN_MEMORY_STORE_H
+#define IN_MEMORY_STORE_H
+
+#include "compact_game_store.h"
+#include "storage_backend.h"
+#include <cstdint>
+#include <mutex>
+
+class InMemoryStore : public StorageBackend {
+public:
+    void setSyncWrites(bool) override {}
+
+    bool saveUsers(const std::unordered_map<std::string, UserProfile>& users) override;
+    std::unordered_map<std::string, UserProfile> loadUsers() override;
+    bool saveUser(const UserProfile& user) override;
+    bool loadUser(const std::string& userId, UserProfile& user) override;
+
+    bool appendGames(const std::vector<GameState>& games) override;
+    bool saveGameHistory(const std::vector<GameState>& games) override;
+    std::vector<GameState> loadGameHistory() override;
+    void forEachGame(const std::function<bool(const GameState&)>& visit) override;
+    std::vector<GameState> loadUserGames(const std::string& userId) override;
+    bool loadGame(const std::string& gameId, GameState& game) override;
+    std::size_t countGames() override;
+
+    bool writeBatch(const std::unordered_map<std::string, UserProfile>& users,
+                    const std::vector<GameState>& games) override;
+
+    bool hasIndexedLookups() const override { return true; }
+
+private:
+    // Callers hold 'mutex'.
+    void putGame(const GameState& game);
+    void indexPlayers(std::size_t slot);
+    void unindexPlayers(std::size_t slot);
+    bool findSlot(const std::string& gameId, std::size_t& slot) const;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, UserProfile> users;
+    CompactGameStore games;
+    std::unordered_map<std::uint64_t, std::size_t> slotById;
+    // Slots of the games each player took part in, by player key.
+    std::unordered_map<std::uint32_t, std::vector<std::size_t>> slotsByPlayer;
+};
+
+#endif // IN_MEMORY_STORE_H
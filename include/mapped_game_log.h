@@ -0,0 +1,78 @@
+/*
+================================================================================
+File: include/mapped_game_log.h
+Purpose: Declares MappedGameLog, read-only zero-copy access to a binary game
+         log. The file is memory-mapped and open() only walks the record
+         boundaries. A record is checksummed and decoded in place, as
+         string_views into the mapping, when it is asked for. Opening a
+         large archive therefore costs one offset per game, and the pages
+         actually read are the ones the caller touches.
+         A mapped file can't be replaced on Windows, so DatabaseManager
+         closes the mappings it handed out before it rewrites or trims the
+         log, and reopens them on the new file afterwards.
+================================================================================
+*/
+#ifndef MAPPED_GAME_LOG_H
+#define MAPPED_GAME_LOG_H
+
+#include "game_logic.h"
+#include "record_format.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+class QFile;
+
+class MappedGameLog {
+public:
+    MappedGameLog();
+    ~MappedGameLog();
+
+    MappedGameLog(const MappedGameLog&) = delete;
+    MappedGameLog& operator=(const MappedGameLog&) = delete;
+
+    // Maps 'path' and indexes its records. Fails for missing or empty files
+    // and for logs that are not in the binary format.
+    bool open(const std::string& path);
+    bool isOpen() const { return data != nullptr; }
+
+    // Unmaps the file, leaving no records, and maps it again. Record
+    // numbers need not survive a reopen (compaction drops records), so
+    // each one bumps generation().
+    void close();
+    bool reopen();
+    std::uint64_t generation() const { return reopened; }
+
+    // Held by readers on another thread than the one that rewrites the
+    // log, for as long as they use sizes, record numbers, or views.
+    std::shared_lock<std::shared_mutex> lockForReading() const { return std::shared_lock<std::shared_mutex>(mutex); }
+
+    // Records in file order. A game id appended twice appears twice; the
+    // full loader (DatabaseManager::loadGameHistory) resolves that.
+    std::size_t size() const { return recordOffsets.size(); }
+
+    // True if indexing stopped at a torn record before the end of the file.
+    bool hasTornTail() const { return tornTail; }
+
+    // Decodes record 'index' in place. False if it fails its checksum.
+    // The view stays valid until the log is closed or reopened.
+    bool view(std::size_t index, record_format::GameRecordView& record) const;
+    bool materialize(std::size_t index, GameState& game) const;
+
+private:
+    std::string path;
+    // Exclusive while close() and reopen() change the mapping.
+    mutable std::shared_mutex mutex;
+    std::uint64_t reopened = 0;
+    std::unique_ptr<QFile> file;
+    const char* data = nullptr;
+    std::size_t dataSize = 0;
+    std::vector<std::uint64_t> recordOffsets;
+    bool tornTail = false;
+};
+
+#endif // MAPPED_GAME_LOG_H
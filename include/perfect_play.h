@@ -0,0 +1,50 @@
+/*
+================================================================================
+File: include/perfect_play.h
+Purpose: O(1) perfect play for the 3x3 board. Every position is encoded as
+         a base-3 number (one digit per cell: 0 empty, 1 X, 2 O), giving
+         3^9 = 19683 codes. The best move for each reachable code is solved
+         at build time by the generate_perfect_play tool and compiled into
+         perfect_play.cpp as a flat table.
+================================================================================
+*/
+#ifndef PERFECT_PLAY_H
+#define PERFECT_PLAY_H
+
+#include "game_logic.h"
+#include <array>
+#include <cstdint>
+
+namespace perfect_play {
+
+constexpr int kPositionCount = 19683; // 3^9
+
+// kTernary[bits] reads a 9-bit mask as base-3 digits, e.g. 0b101 -> 1 + 9.
+using TernaryTable = std::array<std::uint16_t, 1 << GameLogic::kClassicCellCount>;
+
+constexpr TernaryTable buildTernaryTable() {
+    TernaryTable table{};
+    std::uint16_t power = 1;
+    int top = -1;
+    for (int bits = 1; bits < (1 << GameLogic::kClassicCellCount); ++bits) {
+        if ((bits & (bits - 1)) == 0) {
+            if (++top > 0) power = static_cast<std::uint16_t>(power * 3);
+        }
+        table[bits] = static_cast<std::uint16_t>(table[bits ^ (1 << top)] + power);
+    }
+    return table;
+}
+
+inline constexpr TernaryTable kTernary = buildTernaryTable();
+
+constexpr int encode(Bitboard xBits, Bitboard oBits) {
+    return kTernary[xBits] + 2 * kTernary[oBits];
+}
+
+// Best cell (row * 3 + col) for the player to move, or -1 if the position
+// is finished or cannot arise in a legal game.
+int bestCell(Bitboard xBits, Bitboard oBits);
+
+} // namespace perfect_play
+
+#endif // PERFECT_PLAY_H
@@ -0,0 +1,85 @@
+/*
+================================================================================
+File: include/persistence_writer.h
+Purpose: Declares PersistenceWriter, which moves StorageBackend writes off
+         the GUI thread. saveUser and appendGame only queue the update and
+         return. A dedicated writer thread waits a short coalescing window,
+         then writes everything pending as one batch: the latest profile of
+         each user that changed, and all new games, in one writeBatch call.
+         flush() blocks until everything queued so far is on disk, and the
+         destructor flushes before it joins the thread, so nothing is lost
+         on exit.
+
+         Once updates are queued, the writer thread is the only one that
+         touches the backend. Loads at startup have to happen before the
+         first update is queued. There are two exceptions, both reads:
+         backends with indexed lookups may keep being queried, and
+         DatabaseManager::forEachGame may keep streaming the game log (see
+         database_manager.h), which is how GameHistory reaches older games.
+================================================================================
+*/
+#ifndef PERSISTENCE_WRITER_H
+#define PERSISTENCE_WRITER_H
+
+#include "game_logic.h"
+#include "user_auth.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class StorageBackend;
+
+class PersistenceWriter {
+public:
+    static constexpr std::chrono::milliseconds kDefaultCoalesceWindow{100};
+
+    explicit PersistenceWriter(StorageBackend& storage,
+                               std::chrono::milliseconds coalesceWindow = kDefaultCoalesceWindow);
+    ~PersistenceWriter();
+
+    PersistenceWriter(const PersistenceWriter&) = delete;
+    PersistenceWriter& operator=(const PersistenceWriter&) = delete;
+
+    // Queue an update. A user saved again before the batch is written is
+    // written once, with the latest profile.
+    void saveUser(const UserProfile& user);
+    void appendGame(const GameState& game);
+
+    // Blocks until every update queued before the call has been written.
+    void flush();
+
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t userWrites = 0;
+        std::uint64_t gameWrites = 0;
+        std::uint64_t failedWrites = 0;
+    };
+    Stats getStats() const;
+
+private:
+    void writerLoop();
+
+    StorageBackend& db;
+    const std::chrono::milliseconds coalesceWindow;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable written;
+    std::unordered_map<std::string, UserProfile> pendingUsers;
+    std::vector<GameState> pendingGames;
+    // Sequence numbers of the last queued update and the last one on disk.
+    std::uint64_t queuedSeq = 0;
+    std::uint64_t writtenSeq = 0;
+    int flushWaiters = 0;
+    bool stopping = false;
+    Stats stats;
+
+    std::thread thread;
+};
+
+#endif // PERSISTENCE_WRITER_H
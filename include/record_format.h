@@ -0,0 +1,122 @@
+/*
+================================================================================
+File: include/record_format.h
+Purpose: The binary on-disk format for the game log and the user store.
+         Both files start with an 8-byte header (4-byte magic, a version
+         byte, 3 reserved bytes). Integers are LEB128 varints and strings
+         are varint-length prefixed.
+
+         Game records are framed as <varint length><payload><crc32 LE>, so
+         a torn append at the end of the log fails to frame or to checksum.
+         Moves are cell indices: two per byte (4 bits each) on boards of up
+         to 16 cells, one per byte on larger boards. Results, flags, board
+         geometry and timestamps are stored as integers.
+
+         User records are <state byte><id><username><password hash> then a
+         fixed 40-byte little-endian stats block. A profile's stats can
+         therefore be rewritten in place without changing its length. The
+         user store's write-ahead journal holds framed user records.
+================================================================================
+*/
+#ifndef RECORD_FORMAT_H
+#define RECORD_FORMAT_H
+
+#include "game_logic.h"
+#include "user_auth.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace record_format {
+
+constexpr char kGamesMagic[4] = {'T', 'T', 'T', 'G'};
+constexpr char kUsersMagic[4] = {'T', 'T', 'T', 'U'};
+constexpr std::uint8_t kVersion = 1;
+constexpr std::size_t kHeaderSize = 8;
+// Far larger than any game or user record; a length prefix above it can
+// only be damage.
+constexpr std::uint64_t kMaxFrameBytes = 64 * 1024;
+
+// Record state bytes in the user store.
+constexpr std::uint8_t kUserLive = 'U';
+constexpr std::uint8_t kUserDead = 0;
+
+std::string fileHeader(const char (&magic)[4]);
+// The format version if 'data' starts with this magic, otherwise 0.
+int headerVersion(const char* data, std::size_t size, const char (&magic)[4]);
+
+std::uint32_t crc32(const char* data, std::size_t size);
+
+void putVarint(std::string& out, std::uint64_t value);
+// Reads a varint at 'p' and advances it; false if it runs past 'end'.
+bool getVarint(const char*& p, const char* end, std::uint64_t& value);
+
+// "YYYY-MM-DD HH:MM:SS" <-> seconds since 1970-01-01 00:00:00 of the same
+// (local) wall clock. parseTimestamp fails on anything that would not
+// format back to exactly the same string.
+bool parseTimestamp(const std::string& text, std::int64_t& seconds);
+std::string formatTimestamp(std::int64_t seconds);
+
+// Appends a complete framed game record to 'out'.
+void appendGameRecord(std::string& out, const GameState& game);
+
+// Appends the cell indices of 'moves' packed as a game record stores them;
+// unpackMoves reverses it, failing on a wrong length or an off-board cell.
+void packMoves(std::string& out, const std::vector<Move>& moves, int boardSize);
+bool unpackMoves(std::string_view packed, int count, int boardSize, std::vector<Move>& moves);
+
+enum class FrameStatus { Ok, Corrupt, Truncated };
+// Reads the framed record at 'p'. On Ok, 'p' is moved past the record. On
+// Corrupt it is moved past as much of the record as its length prefix can
+// be trusted for, so a reader going on should use findFrame instead. On
+// Truncated the record runs past 'end': more of it may still be to come,
+// or it is a torn tail.
+FrameStatus readGameRecord(const char*& p, const char* end, GameState& game);
+// Frames any payload as <varint length><payload><crc32 LE>. readFrame uses
+// the same status rules as readGameRecord but only locates the payload;
+// skipping the checksum lets a caller find record boundaries without
+// reading every byte.
+void appendFrame(std::string& out, std::string_view payload);
+FrameStatus readFrame(const char*& p, const char* end, std::string_view& payload,
+                      bool verifyChecksum = true);
+// The first position in [p, end) where an intact frame starts, or 'end' if
+// there is none. A record that fails to read may have a damaged length
+// prefix, so this, not the prefix, is how a reader finds the next record.
+const char* findFrame(const char* p, const char* end);
+
+// A game record decoded in place: the strings and packed moves point into
+// the buffer the payload came from and are only valid as long as it is.
+struct GameRecordView {
+    std::string_view gameId;
+    std::string_view player1Id;
+    std::string_view player2Id;
+    bool isAIOpponent = false;
+    GameResult result = GameResult::IN_PROGRESS;
+    int boardSize = 0;
+    int winLength = 0;
+    // Timestamps that don't fit "YYYY-MM-DD HH:MM:SS" are kept verbatim.
+    bool textTimestamp = false;
+    std::string_view timestampText;
+    std::int64_t timestampSeconds = 0;
+    int durationSeconds = 0;
+    int moveCount = 0;
+    std::string_view packedMoves;
+
+    std::string timestamp() const;
+    Move move(int index) const;
+};
+
+bool decodeGameView(std::string_view payload, GameRecordView& view);
+// Copies a view into an owning GameState.
+void materializeGame(const GameRecordView& view, GameState& game);
+
+std::string encodeUser(const UserProfile& user);
+// Decodes the user record at 'p' and advances past it. 'live' reports
+// whether the record has been superseded.
+bool decodeUser(const char*& p, const char* end, UserProfile& user, bool& live);
+
+} // namespace record_format
+
+#endif // RECORD_FORMAT_H
@@ -0,0 +1,58 @@
+/*
+================================================================================
+File: include/replay_cursor.h
+Purpose: Declares ReplayCursor, a recorded game prepared for scrubbing. The
+         position after every ply (both players' stones and the result) is
+         computed once when the cursor is built, so stepping forwards or
+         backwards and jumping to any move read a snapshot instead of
+         replaying moves from the start. A snapshot is two BoardMasks, so
+         even a full 15x15 game keeps only a few kilobytes.
+================================================================================
+*/
+#ifndef REPLAY_CURSOR_H
+#define REPLAY_CURSOR_H
+
+#include <vector>
+
+#include "game_logic.h"
+
+class ReplayCursor {
+public:
+    // An empty 3x3 game.
+    ReplayCursor();
+    // Replays the game once. Moves after the first illegal one are dropped.
+    explicit ReplayCursor(const GameState& game);
+
+    int getBoardSize() const { return boardSize; }
+    int getWinLength() const { return winLength; }
+    const std::vector<Move>& getMoves() const { return moves; }
+    int getMoveCount() const { return static_cast<int>(moves.size()); }
+
+    // Number of moves on the board, from 0 to getMoveCount().
+    int getPosition() const { return position; }
+    // Each returns false, and stays put, if there is nowhere to go.
+    bool next();
+    bool previous();
+    // Clamped to [0, getMoveCount()].
+    bool seek(int ply);
+
+    // The board at the current position.
+    Player getCell(int row, int col) const;
+    GameResult getResult() const { return snapshots[position].result; }
+
+private:
+    struct Snapshot {
+        BoardMask x;
+        BoardMask o;
+        GameResult result;
+    };
+
+    int boardSize;
+    int winLength;
+    std::vector<Move> moves;
+    // snapshots[i] is the position after the first i moves.
+    std::vector<Snapshot> snapshots;
+    int position;
+};
+
+#endif // REPLAY_CURSOR_H
@@ -0,0 +1,30 @@
+/*
+================================================================================
+File: include/search_scoring.h
+Purpose: The move order and win score shared by the 3x3 searches: AIEngine's
+         live search and the build-time perfect-play generator. Keeping one
+         copy means the table breaks ties between equally good moves the
+         same way the search does, and scores positions on the same scale.
+================================================================================
+*/
+#ifndef SEARCH_SCORING_H
+#define SEARCH_SCORING_H
+
+#include "game_logic.h"
+#include <array>
+
+namespace search_scoring {
+
+// Centre first, then corners, then edges. Strong moves are tried first so
+// alpha-beta can cut off the weaker siblings early.
+constexpr std::array<int, GameLogic::kClassicCellCount> kMoveOrder = {4, 0, 2, 6, 8, 1, 3, 5, 7};
+
+// A win is worth more the sooner it happens: kWinScore minus the number of
+// moves on the board. Because the score only depends on the position, not on
+// the search root, it stays valid when positions are reused later on.
+// It must exceed the longest possible game (15x15 = 225 moves).
+constexpr int kWinScore = 10000;
+
+} // namespace search_scoring
+
+#endif // SEARCH_SCORING_H
@@ -0,0 +1,73 @@
+/*
+================================================================================
+File: include/sqlite_store.h
+Purpose: Declares SqliteStore, the SQLite storage backend (via Qt6::Sql).
+         Users and games are rows in two tables. Games are indexed by game
+         id, by player and by timestamp, so a user's history, a single game
+         or a single profile is an indexed query rather than a scan of the
+         whole history. Moves are stored as a blob packed the same way as
+         the binary game log.
+
+         The database runs in WAL journal mode, so readers never block the
+         writer. Every multi-row write is one transaction with its
+         statements prepared once. Qt only lets a connection be used (and
+         closed) by the thread that opened it, so each thread gets its own
+         connection to the same file, which it closes when it exits.
+================================================================================
+*/
+#ifndef SQLITE_STORE_H
+#define SQLITE_STORE_H
+
+#include "storage_backend.h"
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class QSqlDatabase;
+
+class SqliteStore : public StorageBackend {
+public:
+    // 'syncWrites' picks synchronous=FULL (every commit is durable) or OFF.
+    SqliteStore(std::string path, bool syncWrites);
+    ~SqliteStore() override;
+
+    SqliteStore(const SqliteStore&) = delete;
+    SqliteStore& operator=(const SqliteStore&) = delete;
+
+    // Opens the database and creates the schema if needed.
+    bool open();
+    // Applies to the calling thread's connection and to any opened later.
+    void setSyncWrites(bool sync) override;
+    bool isEmpty();
+
+    bool saveUsers(const std::unordered_map<std::string, UserProfile>& users) override;
+    std::unordered_map<std::string, UserProfile> loadUsers() override;
+    bool saveUser(const UserProfile& user) override;
+    bool loadUser(const std::string& userId, UserProfile& user) override;
+
+    bool appendGames(const std::vector<GameState>& games) override;
+    bool saveGameHistory(const std::vector<GameState>& games) override;
+    std::vector<GameState> loadGameHistory() override;
+    void forEachGame(const std::function<bool(const GameState&)>& visit) override;
+    std::vector<GameState> loadUserGames(const std::string& userId) override;
+    bool loadGame(const std::string& gameId, GameState& game) override;
+    std::size_t countGames() override;
+
+    // Writes the users and games in a single transaction.
+    bool writeBatch(const std::unordered_map<std::string, UserProfile>& users,
+                    const std::vector<GameState>& games) override;
+
+    bool hasIndexedLookups() const override { return true; }
+
+private:
+    QSqlDatabase connection();
+
+    const std::string path;
+    std::atomic<bool> syncWrites;
+    // Prefix of this store's connection names, unique per store.
+    const std::string connectionPrefix;
+};
+
+#endif // SQLITE_STORE_H
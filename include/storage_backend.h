@@ -0,0 +1,90 @@
+/*
+================================================================================
+File: include/storage_backend.h
+Purpose: The storage interface the rest of the application persists through,
+         and the factory that picks an implementation at startup:
+
+           FlatText   DatabaseManager writing the text layout
+           BinaryLog  DatabaseManager writing the binary layout (the default
+                      for flat files; see record_format.h)
+           SQLite     SqliteStore (see sqlite_store.h)
+           InMemory   InMemoryStore: nothing reaches disk; for tests and as
+                      a baseline when comparing backends
+
+         Every backend stores the same things, so they are interchangeable;
+         they differ in what each operation costs. tests/storage_benchmark.cpp
+         runs the same workloads against each of them.
+================================================================================
+*/
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include "game_logic.h"
+#include "user_auth.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class MappedGameLog;
+
+class StorageBackend {
+public:
+    virtual ~StorageBackend() = default;
+
+    // When true (the default), a write is durable once it returns.
+    virtual void setSyncWrites(bool sync) = 0;
+
+    // Users
+    // saveUsers replaces every stored profile.
+    virtual bool saveUsers(const std::unordered_map<std::string, UserProfile>& users) = 0;
+    virtual std::unordered_map<std::string, UserProfile> loadUsers() = 0;
+    virtual bool saveUser(const UserProfile& user) = 0;
+    virtual bool loadUser(const std::string& userId, UserProfile& user) = 0;
+
+    // Games
+    // A game saved again under the same id replaces the earlier one.
+    virtual bool appendGames(const std::vector<GameState>& games) = 0;
+    bool appendGame(const GameState& game) { return appendGames({game}); }
+    // Replaces every stored game.
+    virtual bool saveGameHistory(const std::vector<GameState>& games) = 0;
+    // All games, in the order they were first saved.
+    virtual std::vector<GameState> loadGameHistory() = 0;
+    // Streams the stored games to 'visit' one at a time, in the same order,
+    // without holding the history in memory; stops early when 'visit'
+    // returns false. 'visit' must not call back into the backend.
+    virtual void forEachGame(const std::function<bool(const GameState&)>& visit) = 0;
+    // The games a user played in, newest first by timestamp. Games with the
+    // same timestamp come in the reverse of loadGameHistory's order, so
+    // the one saved last is first.
+    virtual std::vector<GameState> loadUserGames(const std::string& userId) = 0;
+    virtual bool loadGame(const std::string& gameId, GameState& game) = 0;
+    virtual std::size_t countGames() = 0;
+
+    // Writes a batch of user updates and new games together, as one
+    // transaction where the backend has them.
+    virtual bool writeBatch(const std::unordered_map<std::string, UserProfile>& users,
+                            const std::vector<GameState>& games) = 0;
+
+    // True if loadUserGames, loadGame and countGames are indexed, and so
+    // cheap enough to call per lookup instead of loading the history, and
+    // may be called while another thread writes.
+    virtual bool hasIndexedLookups() const { return false; }
+    // A zero-copy view of the history, for backends that keep one on disk.
+    virtual std::shared_ptr<const MappedGameLog> mapGameHistory() { return nullptr; }
+};
+
+enum class StorageKind { FlatText, BinaryLog, SQLite, InMemory };
+
+// "text", "binary", "sqlite", "memory".
+const char* storageKindName(StorageKind kind);
+bool parseStorageKind(const std::string& name, StorageKind& kind);
+
+// Opens the backend of this kind at 'path' (the flat files are named after
+// it, the SQLite database is the file itself). A new, empty SQLite database
+// imports any flat files at the same path. Returns null if it can't be opened.
+std::unique_ptr<StorageBackend> openStorage(StorageKind kind, const std::string& path);
+
+#endif // STORAGE_BACKEND_H
@@ -0,0 +1,49 @@
+/*
+================================================================================
+File: include/thread_pool.h
+Purpose: Declares ThreadPool, a small fork-join pool used by the parallel AI
+         search and the game log loader. run() hands the same task to every
+         thread, passing each its index, and returns once all of them have
+         finished. The calling thread does the work of index 0, so a pool of
+         size N keeps N - 1 threads parked between runs.
+================================================================================
+*/
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount = 1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total number of threads taking part in run(), including the caller.
+    int size() const;
+
+    // Runs task(0) on the calling thread and task(1) .. task(size() - 1) on
+    // the pool's threads, then waits for all of them. Not reentrant.
+    void run(const std::function<void(int)>& task);
+
+private:
+    void workerLoop(int index);
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::condition_variable allDone;
+    const std::function<void(int)>* currentTask;
+    std::uint64_t generation;  // Bumped by every run() so workers see new work.
+    int pending;               // Workers still busy with the current run.
+    bool stopping;
+};
+
+#endif // THREAD_POOL_H
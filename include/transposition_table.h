@@ -0,0 +1,88 @@
+/*
+================================================================================
+File: include/transposition_table.h
+Purpose: Declares the TranspositionTable used by AIEngine. It caches search
+         results keyed by the position's Zobrist hash so positions reached
+         through different move orders are only solved once. The table is a
+         fixed-size, direct-mapped array whose entry count is a power of two.
+         probe and store are lock-free, so parallel search threads can share
+         one table (see transposition_table.cpp for how torn entries are
+         detected).
+================================================================================
+*/
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class TranspositionTable {
+public:
+    // How a stored score relates to the true value of the position.
+    enum Bound : std::uint8_t {
+        EXACT,  // The score is the exact value.
+        LOWER,  // The search failed high: true value >= score.
+        UPPER   // The search failed low: true value <= score.
+    };
+
+    struct Entry {
+        std::uint64_t key = 0;
+        std::int16_t score = 0;
+        std::int16_t bestCell = -1;
+        // Plies searched below this position; a score is only reusable by a
+        // search that needs the same depth or less.
+        std::uint8_t depth = 0;
+        Bound bound = EXACT;
+        bool occupied = false;
+    };
+
+    // Counters describing how effective the cache is.
+    struct Stats {
+        long long hits = 0;        // Probe found an entry for the same key.
+        long long misses = 0;      // Probe found nothing usable.
+        long long collisions = 0;  // Misses where the slot held another key.
+        long long stores = 0;
+    };
+
+    static constexpr std::size_t kDefaultEntryCount = std::size_t(1) << 16;
+
+    explicit TranspositionTable(std::size_t entryCount = kDefaultEntryCount);
+
+    // Resizes the table (rounded up to a power of two) and drops all entries.
+    // Not thread-safe: only call while no search is running.
+    void resize(std::size_t entryCount);
+    void clear();
+    std::size_t size() const;
+
+    // Returns true and fills 'entry' if the table holds this key. Safe to
+    // call from several threads at once, as is store.
+    bool probe(std::uint64_t key, Entry& entry);
+    void store(std::uint64_t key, int depth, int score, Bound bound, int bestCell);
+
+    // A snapshot of the counters.
+    Stats getStats() const;
+    void resetStats();
+
+private:
+    // The entry's fields are packed into 'data'; 'check' holds key ^ data.
+    struct Slot {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    struct Counters {
+        std::atomic<long long> hits{0};
+        std::atomic<long long> misses{0};
+        std::atomic<long long> collisions{0};
+        std::atomic<long long> stores{0};
+    };
+
+    std::unique_ptr<Slot[]> entries;
+    std::size_t slotCount;
+    std::size_t indexMask;
+    Counters counters;
+};
+
+#endif // TRANSPOSITION_TABLE_H
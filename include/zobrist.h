@@ -0,0 +1,61 @@
+/*
+================================================================================
+File: include/zobrist.h
+Purpose: Compile-time Zobrist keys used to hash board positions. Each
+         (player, cell) pair gets a fixed pseudo-random 64-bit key, and a
+         position's hash is the XOR of the keys of its occupied cells, so
+         GameLogic can update it incrementally on every move and undo.
+         Keys cover the largest supported board; a per-geometry seed keeps
+         positions from different board sizes apart.
+================================================================================
+*/
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "game_logic.h"
+#include <array>
+#include <cstdint>
+
+namespace zobrist {
+
+// SplitMix64: a tiny, well-mixed generator that also works in constexpr.
+constexpr std::uint64_t splitMix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+using KeyTable = std::array<std::array<std::uint64_t, GameLogic::kMaxCellCount>, 2>;
+
+constexpr KeyTable generateKeys() {
+    KeyTable keys{};
+    std::uint64_t state = 0x7A11C0DEull;
+    for (int player = 0; player < 2; ++player) {
+        for (int cell = 0; cell < GameLogic::kMaxCellCount; ++cell) {
+            keys[player][cell] = splitMix64(state);
+        }
+    }
+    return keys;
+}
+
+inline constexpr KeyTable kKeys = generateKeys();
+
+// X uses row 0 of the table and O uses row 1.
+constexpr std::uint64_t key(Player player, int cell) {
+    return kKeys[player == Player::X ? 0 : 1][cell];
+}
+
+// Starting hash of an empty board with the given geometry. Classic 3x3 keeps
+// the historical empty-board hash of 0.
+constexpr std::uint64_t configKey(int boardSize, int winLength) {
+    if (boardSize == GameLogic::kClassicBoardSize && winLength == GameLogic::kClassicBoardSize) {
+        return 0;
+    }
+    std::uint64_t state = (std::uint64_t(boardSize) << 8) | std::uint64_t(winLength);
+    return splitMix64(state);
+}
+
+} // namespace zobrist
+
+#endif // ZOBRIST_H
@@ -1,18 +1,52 @@
 /*
 ================================================================================
 File: src/ai_engine.cpp
-Purpose: Implements a stable minimax algorithm and adds a debug message
-         to confirm this file is being correctly compiled and run.
+Purpose: Implements the AI move search. HARD uses alpha-beta negamax by
+         default; the original minimax is still available through
+         setSearchMode for comparison. Classic 3x3 is solved exactly; larger
+         boards are searched by iterative deepening around the existing
+         stones, with the root moves of each iteration shared out among the
+         engine's threads.
 ================================================================================
 */
 #include "ai_engine.h"
+#include "board_symmetry.h"
+#include "perfect_play.h"
+#include "search_scoring.h"
 #include <vector>
 #include <algorithm>
+#include <array>
 #include <random>
 #include <limits>
-#include <iostream> // For the std::cout debug message
+#include <cstdlib>
 
-AIEngine::AIEngine() : currentDifficulty(HARD) {}
+namespace {
+
+using search_scoring::kMoveOrder;
+using search_scoring::kWinScore;
+
+// Deepest iteration the search will attempt; it fits the table's depth field.
+constexpr int kMaxSearchDepth = 64;
+
+// Value of a window of winLength cells holding n stones of one player and
+// none of the other. Each extra stone is worth eight times as much.
+constexpr int kThreatWeights[] = {0, 1, 8, 64, 512, 4096};
+
+// Evaluations are clipped to this, so they always rank below a real win.
+constexpr int kMaxEvaluation = kWinScore / 2;
+
+int movesPlayed(const GameLogic& game) {
+    return static_cast<int>(game.getMoveHistory().size());
+}
+
+} // namespace
+
+AIEngine::AIEngine()
+    : currentDifficulty(HARD), searchMode(ALPHA_BETA), nodeCount(0), useTranspositionTable(true),
+      useSymmetry(true), useLookupTable(true), stopFlag(nullptr), timeBudget(kDefaultTimeBudget),
+      hasDeadline(false), timeUp(false), lastSearchDepth(0), depthLimit(0), threadCount(1), cellOrderBoardSize(0) {}
+
+AIEngine::~AIEngine() = default;
 
 void AIEngine::setDifficulty(int level) {
     if (level == 0) {
@@ -22,11 +56,110 @@ void AIEngine::setDifficulty(int level) {
     }
 }
 
+void AIEngine::setSearchMode(SearchMode mode) {
+    searchMode = mode;
+}
+
+AIEngine::SearchMode AIEngine::getSearchMode() const {
+    return searchMode;
+}
+
+long long AIEngine::getLastNodeCount() const {
+    return nodeCount;
+}
+
+void AIEngine::setTimeBudget(std::chrono::milliseconds budget) {
+    timeBudget = budget;
+}
+
+std::chrono::milliseconds AIEngine::getTimeBudget() const {
+    return timeBudget;
+}
+
+int AIEngine::getLastSearchDepth() const {
+    return lastSearchDepth;
+}
+
+void AIEngine::setDepthLimit(int plies) {
+    depthLimit = std::max(plies, 0);
+}
+
+void AIEngine::setThreadCount(int count) {
+    count = std::max(count, 1);
+    if (count == threadCount) return;
+    threadCount = count;
+    threadPool.reset(count > 1 ? new ThreadPool(count) : nullptr);
+}
+
+int AIEngine::getThreadCount() const {
+    return threadCount;
+}
+
+void AIEngine::setUseTranspositionTable(bool enabled) {
+    useTranspositionTable = enabled;
+}
+
+void AIEngine::setTranspositionTableSize(std::size_t entryCount) {
+    transpositionTable.resize(entryCount);
+}
+
+void AIEngine::clearTranspositionTable() {
+    transpositionTable.clear();
+    canonicalMoveCache.clear();
+}
+
+TranspositionTable::Stats AIEngine::getTranspositionStats() const {
+    return transpositionTable.getStats();
+}
+
+void AIEngine::resetTranspositionStats() {
+    transpositionTable.resetStats();
+}
+
+void AIEngine::setUseSymmetry(bool enabled) {
+    if (enabled != useSymmetry) {
+        // Entries are keyed differently in the two modes, so start afresh.
+        clearTranspositionTable();
+    }
+    useSymmetry = enabled;
+}
+
+void AIEngine::setUseLookupTable(bool enabled) {
+    useLookupTable = enabled;
+}
+
+void AIEngine::setStopFlag(const std::atomic<bool>* flag) {
+    stopFlag = flag;
+}
+
+bool AIEngine::stopRequested(SearchThread& thread) {
+    if (thread.aborted) return true;
+    if ((stopFlag && stopFlag->load(std::memory_order_relaxed)) || timeUp.load(std::memory_order_relaxed)) {
+        thread.aborted = true;
+    } else if (hasDeadline && (thread.nodes & 1023) == 0 && std::chrono::steady_clock::now() >= deadline) {
+        // Reading the clock every node would cost more than the search, so
+        // each thread samples it once every 1024 nodes and tells the others.
+        timeUp.store(true, std::memory_order_relaxed);
+        thread.aborted = true;
+    }
+    return thread.aborted;
+}
+
+std::uint64_t AIEngine::positionKey(const GameLogic& game, int& transform) const {
+    if (!useSymmetry || !game.isClassic()) {
+        transform = 0;
+        return game.getHashKey();
+    }
+    symmetry::Canonical canonical =
+        symmetry::canonicalize(game.getPlayerBits(Player::X), game.getPlayerBits(Player::O));
+    transform = canonical.transform;
+    return symmetry::hashKey(canonical.key);
+}
+
 Move AIEngine::getBestMove(GameLogic& game) {
-    // --- DEBUG TEST ---
-    // This message should appear in your Application Output right before the AI moves.
-    // If it doesn't appear and the game crashes, the old file is still being used.
-    std::cout << "--- AI IS THINKING (NEW CODE) ---" << std::endl;
+    nodeCount = 0;
+    timeUp.store(false, std::memory_order_relaxed);
+    lastSearchDepth = 0;
 
     if (currentDifficulty == EASY) {
         std::vector<Move> availableMoves = game.getAvailableMoves();
@@ -38,51 +171,376 @@ Move AIEngine::getBestMove(GameLogic& game) {
         std::uniform_int_distribution<> distrib(0, availableMoves.size() - 1);
         return availableMoves[distrib(gen)];
     }
-    
-    return findBestMove(game);
+
+    // The lookup table and the reference minimax only know the 3x3 game.
+    if (game.isClassic()) {
+        if (useLookupTable) {
+            int cell = perfect_play::bestCell(game.getPlayerBits(Player::X), game.getPlayerBits(Player::O));
+            if (cell >= 0) {
+                return Move(cell / GameLogic::kClassicBoardSize, cell % GameLogic::kClassicBoardSize);
+            }
+        }
+        if (searchMode == MINIMAX) {
+            return findBestMove(game);
+        }
+    }
+    return findBestMoveAlphaBeta(game);
 }
 
 Move AIEngine::findBestMove(GameLogic& game) {
     int bestVal = std::numeric_limits<int>::min();
     Move bestMove = {-1, -1};
-    std::vector<Move> availableMoves = game.getAvailableMoves();
+    MoveList availableMoves;
+    game.getAvailableMoves(availableMoves);
+    SearchThread thread;
 
     for (const auto& move : availableMoves) {
         game.makeMove(move.row, move.col);
-        int moveVal = minimax(game, false);
+        int moveVal = minimax(thread, game, false);
         game.undoLastMove();
+        if (stopRequested(thread)) break;
 
         if (moveVal > bestVal) {
             bestMove = move;
             bestVal = moveVal;
         }
     }
-    return bestMove;
+    nodeCount = thread.nodes;
+    return thread.aborted ? Move(-1, -1) : bestMove;
 }
 
 // The recursive minimax function now correctly uses pass-by-reference.
-int AIEngine::minimax(GameLogic& game, bool isMaximizing) {
+int AIEngine::minimax(SearchThread& thread, GameLogic& game, bool isMaximizing) {
+    thread.nodes++;
+    if (stopRequested(thread)) return 0; // The caller discards the result.
     GameResult result = game.checkGameResult();
 
     if (result == GameResult::O_WINS) return 10;
     if (result == GameResult::X_WINS) return -10;
     if (result == GameResult::DRAW) return 0;
 
+    // MoveList lives on the stack, so the recursion does no heap allocation.
+    MoveList moves;
+    game.getAvailableMoves(moves);
+
     if (isMaximizing) {
         int best = std::numeric_limits<int>::min();
-        for (const auto& move : game.getAvailableMoves()) {
+        for (const auto& move : moves) {
             game.makeMove(move.row, move.col);
-            best = std::max(best, minimax(game, !isMaximizing));
+            best = std::max(best, minimax(thread, game, !isMaximizing));
             game.undoLastMove();
         }
         return best;
     } else {
         int best = std::numeric_limits<int>::max();
-        for (const auto& move : game.getAvailableMoves()) {
+        for (const auto& move : moves) {
             game.makeMove(move.row, move.col);
-            best = std::min(best, minimax(game, !isMaximizing));
+            best = std::min(best, minimax(thread, game, !isMaximizing));
             game.undoLastMove();
         }
         return best;
     }
 }
+
+// Root of the alpha-beta search. Unlike findBestMove, this searches for
+// whichever player is to move, so it also gives correct hints for X.
+Move AIEngine::findBestMoveAlphaBeta(GameLogic& game) {
+    const bool classic = game.isClassic();
+    const bool useCanonical = useSymmetry && classic;
+    // Every rotated/mirrored copy of an already-solved position is answered
+    // from the cache by mapping the canonical move back onto this board.
+    symmetry::Canonical canonical{0, 0};
+    if (useCanonical) {
+        canonical = symmetry::canonicalize(game.getPlayerBits(Player::X), game.getPlayerBits(Player::O));
+        auto cached = canonicalMoveCache.find(canonical.key);
+        if (cached != canonicalMoveCache.end()) {
+            int cell = symmetry::inverseCell(cached->second, canonical.transform);
+            return Move(cell / GameLogic::kClassicBoardSize, cell % GameLogic::kClassicBoardSize);
+        }
+    }
+
+    // A forced move needs no search (e.g. the centre on an empty large board).
+    MoveList rootMoves;
+    orderMoves(game, -1, rootMoves);
+    if (rootMoves.size() == 1) {
+        return rootMoves[0];
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    hasDeadline = timeBudget.count() > 0;
+    deadline = start + timeBudget;
+
+    // 3x3 is solved in one go: a full-depth search takes well under a
+    // millisecond, and its scores are exact. Larger boards deepen one ply at
+    // a time, each iteration trying the previous best move first.
+    const int remaining = game.getCellCount() - movesPlayed(game);
+    int maxDepth = std::min(remaining, kMaxSearchDepth);
+    if (depthLimit > 0 && !classic) maxDepth = std::min(maxDepth, depthLimit);
+    // 3x3 searches finish faster than threads can be woken, so they stay serial.
+    std::vector<SearchThread> threads(classic ? 1 : threadCount);
+    Move bestMove = {-1, -1};
+    int bestCell = -1;
+    bool exact = false;
+    for (int depth = classic ? maxDepth : 1; depth <= maxDepth; ++depth) {
+        Move move;
+        int score = 0;
+        if (!searchRoot(threads, game, depth, bestCell, move, score)) break;
+        bestMove = move;
+        bestCell = GameLogic::cellIndex(move.row, move.col, game.getBoardSize());
+        lastSearchDepth = depth;
+
+        // Stop early once the result is known: a forced win or loss, or the
+        // search reached the end of the game.
+        exact = depth == remaining || std::abs(score) >= kWinScore - GameLogic::kMaxCellCount;
+        if (exact) break;
+        // The next iteration costs several times this one; don't start it
+        // if it cannot finish in time.
+        if (hasDeadline && std::chrono::steady_clock::now() - start > timeBudget / 2) break;
+    }
+    hasDeadline = false;
+    for (const SearchThread& thread : threads) {
+        nodeCount += thread.nodes;
+    }
+
+    if (stopFlag && stopFlag->load(std::memory_order_relaxed)) return {-1, -1};
+    if (bestMove.row == -1) {
+        // Out of time before even depth 1 finished: fall back to the move
+        // ordering's first choice, which is always legal.
+        return rootMoves.empty() ? Move(-1, -1) : rootMoves[0];
+    }
+
+    if (useCanonical && exact) {
+        int cell = GameLogic::cellIndex(bestMove.row, bestMove.col);
+        canonicalMoveCache[canonical.key] =
+            static_cast<std::int8_t>(symmetry::transformCell(cell, canonical.transform));
+    }
+    return bestMove;
+}
+
+bool AIEngine::searchRoot(std::vector<SearchThread>& threads, GameLogic& game, int depth, int firstCell,
+                          Move& bestMove, int& bestScore) {
+    const int beta = kWinScore + 1;
+    bestMove = {-1, -1};
+    MoveList moves;
+    orderMoves(game, firstCell, moves);
+
+    if (threads.size() == 1 || !threadPool) {
+        SearchThread& thread = threads[0];
+        int alpha = -kWinScore - 1;
+        for (const Move& move : moves) {
+            game.makeMove(move.row, move.col);
+            int score = -negamax(thread, game, depth - 1, -beta, -alpha);
+            game.undoLastMove();
+            if (stopRequested(thread)) return false;
+
+            if (score > alpha) {
+                alpha = score;
+                bestMove = move;
+            }
+        }
+        bestScore = alpha;
+        return bestMove.row != -1;
+    }
+
+    // Root split. The first move (last iteration's best) is searched alone
+    // to get a good alpha; after that every thread takes the next unsearched
+    // root move until none are left. The best score so far is shared, so
+    // moves searched later are cut off as hard as in the serial loop.
+    const int moveCount = moves.size();
+    std::vector<int> scores(moveCount);
+    std::vector<int> alphaUsed(moveCount);
+    alphaUsed[0] = -kWinScore - 1;
+    game.makeMove(moves[0].row, moves[0].col);
+    scores[0] = -negamax(threads[0], game, depth - 1, -beta, -alphaUsed[0]);
+    game.undoLastMove();
+    if (stopRequested(threads[0])) return false;
+
+    std::atomic<int> nextMove(1);
+    std::atomic<int> sharedAlpha(scores[0]);
+
+    threadPool->run([&](int index) {
+        SearchThread& thread = threads[index];
+        GameLogic board = game; // Each thread plays moves on its own copy.
+        for (int i = nextMove.fetch_add(1); i < moveCount; i = nextMove.fetch_add(1)) {
+            const int alpha = sharedAlpha.load();
+            board.makeMove(moves[i].row, moves[i].col);
+            int score = -negamax(thread, board, depth - 1, -beta, -alpha);
+            board.undoLastMove();
+            if (stopRequested(thread)) return;
+
+            scores[i] = score;
+            alphaUsed[i] = alpha;
+            int current = sharedAlpha.load();
+            while (score > current && !sharedAlpha.compare_exchange_weak(current, score)) {
+            }
+        }
+    });
+
+    for (const SearchThread& thread : threads) {
+        if (thread.aborted) return false;
+    }
+    // A score at or below the alpha it was searched with is only an upper
+    // bound, so only moves that beat their window can be the best move.
+    // Ties go to the earlier move, as in the serial loop.
+    bestScore = -kWinScore - 1;
+    for (int i = 0; i < moveCount; ++i) {
+        if (scores[i] > alphaUsed[i] && scores[i] > bestScore) {
+            bestScore = scores[i];
+            bestMove = moves[i];
+        }
+    }
+    return bestMove.row != -1;
+}
+
+int AIEngine::negamax(SearchThread& thread, GameLogic& game, int depth, int alpha, int beta) {
+    thread.nodes++;
+    if (stopRequested(thread)) return 0; // The caller discards the result.
+    GameResult result = game.checkGameResult();
+    if (result == GameResult::DRAW) return 0;
+    if (result != GameResult::IN_PROGRESS) {
+        // The previous move ended the game, so the side to move has lost.
+        return -(kWinScore - movesPlayed(game));
+    }
+    if (depth <= 0) return evaluate(game); // Search horizon: nobody has won yet.
+
+    const int originalAlpha = alpha;
+    int transform = 0;
+    const std::uint64_t key = useTranspositionTable ? positionKey(game, transform) : 0;
+    int ttCell = -1;
+    if (useTranspositionTable) {
+        TranspositionTable::Entry entry;
+        if (transpositionTable.probe(key, entry)) {
+            // A shallower result is still a good first move to try.
+            if (entry.depth >= depth) {
+                if (entry.bound == TranspositionTable::EXACT) return entry.score;
+                if (entry.bound == TranspositionTable::LOWER) alpha = std::max(alpha, static_cast<int>(entry.score));
+                if (entry.bound == TranspositionTable::UPPER) beta = std::min(beta, static_cast<int>(entry.score));
+                if (alpha >= beta) return entry.score;
+            }
+            if (entry.bestCell >= 0) {
+                ttCell = (transform == 0) ? entry.bestCell : symmetry::inverseCell(entry.bestCell, transform);
+            }
+        }
+    }
+
+    int best = -kWinScore - 1;
+    int bestCell = -1;
+    const int boardSize = game.getBoardSize();
+    // Try the move remembered by the table first, then the static order.
+    MoveList moves;
+    orderMoves(game, ttCell, moves);
+    for (const Move& move : moves) {
+        const int cell = GameLogic::cellIndex(move.row, move.col, boardSize);
+        game.makeMove(move.row, move.col);
+        int score = -negamax(thread, game, depth - 1, -beta, -alpha);
+        game.undoLastMove();
+        if (stopRequested(thread)) return 0; // Don't let a partial result reach the table.
+
+        if (score > best) {
+            best = score;
+            bestCell = cell;
+            if (best > alpha) {
+                alpha = best;
+                if (alpha >= beta) break; // Opponent will never allow this line.
+            }
+        }
+    }
+
+    if (useTranspositionTable) {
+        TranspositionTable::Bound bound = TranspositionTable::EXACT;
+        if (best <= originalAlpha) {
+            bound = TranspositionTable::UPPER;
+        } else if (best >= beta) {
+            bound = TranspositionTable::LOWER;
+        }
+        // Moves are stored in canonical orientation, like the key.
+        int storedCell = (bestCell >= 0 && transform != 0) ? symmetry::transformCell(bestCell, transform) : bestCell;
+        transpositionTable.store(key, depth, best, bound, storedCell);
+    }
+    return best;
+}
+
+int AIEngine::evaluate(const GameLogic& game) const {
+    // GameLogic keeps every line's stone counts current, so this is a single
+    // pass over the lines with no board access.
+    const std::vector<std::uint8_t>& xCounts = game.getLineCounts(Player::X);
+    const std::vector<std::uint8_t>& oCounts = game.getLineCounts(Player::O);
+    const int lineCount = static_cast<int>(xCounts.size());
+    const int maxWeight = static_cast<int>(sizeof(kThreatWeights) / sizeof(kThreatWeights[0])) - 1;
+
+    int score = 0; // From X's point of view.
+    for (int line = 0; line < lineCount; ++line) {
+        const int xCount = xCounts[line];
+        const int oCount = oCounts[line];
+        if (oCount == 0) score += kThreatWeights[std::min(xCount, maxWeight)];
+        if (xCount == 0) score -= kThreatWeights[std::min(oCount, maxWeight)];
+    }
+
+    score = std::clamp(score, -kMaxEvaluation, kMaxEvaluation);
+    return (game.getCurrentPlayer() == Player::X) ? score : -score;
+}
+
+void AIEngine::orderMoves(const GameLogic& game, int firstCell, MoveList& moves) {
+    moves.clear();
+    const int boardSize = game.getBoardSize();
+    if (firstCell >= 0) {
+        moves.push(Move(firstCell / boardSize, firstCell % boardSize));
+    }
+
+    if (game.isClassic()) {
+        Bitboard occupied = game.getOccupiedBits();
+        for (int cell : kMoveOrder) {
+            if (cell == firstCell || (occupied & (1u << cell))) continue;
+            moves.push(Move(cell / boardSize, cell % boardSize));
+        }
+        return;
+    }
+
+    // Larger boards: centre-out order, restricted to cells touching a stone.
+    // Moves far from every stone are never better than ones next to them,
+    // and skipping them keeps the branching factor small on 15x15.
+    if (cellOrderBoardSize != boardSize) {
+        buildCellOrder(boardSize);
+    }
+    if (game.getMoveHistory().empty()) {
+        // On an empty board the centre is enough.
+        if (firstCell < 0) moves.push(Move(cellOrder[0] / boardSize, cellOrder[0] % boardSize));
+        return;
+    }
+    const BoardMask occupied = game.getPlayerMask(Player::X) | game.getPlayerMask(Player::O);
+    for (int cell : cellOrder) {
+        if (cell == firstCell || occupied.test(cell)) continue;
+        const int row = cell / boardSize;
+        const int col = cell % boardSize;
+        bool nearStone = false;
+        for (int dr = -1; dr <= 1 && !nearStone; ++dr) {
+            for (int dc = -1; dc <= 1 && !nearStone; ++dc) {
+                const int r = row + dr;
+                const int c = col + dc;
+                if (r >= 0 && r < boardSize && c >= 0 && c < boardSize &&
+                    occupied.test(GameLogic::cellIndex(r, c, boardSize))) {
+                    nearStone = true;
+                }
+            }
+        }
+        if (nearStone) {
+            moves.push(Move(row, col));
+        }
+    }
+}
+
+void AIEngine::buildCellOrder(int boardSize) {
+    cellOrder.resize(boardSize * boardSize);
+    for (int cell = 0; cell < boardSize * boardSize; ++cell) {
+        cellOrder[cell] = cell;
+    }
+    // Sort by squared distance from the centre (doubled to stay integral).
+    auto distance = [boardSize](int cell) {
+        const int dr = 2 * (cell / boardSize) - (boardSize - 1);
+        const int dc = 2 * (cell % boardSize) - (boardSize - 1);
+        return dr * dr + dc * dc;
+    };
+    std::stable_sort(cellOrder.begin(), cellOrder.end(),
+                     [&distance](int a, int b) { return distance(a) < distance(b); });
+    cellOrderBoardSize = boardSize;
+}
@@ -0,0 +1,87 @@
+/*
+================================================================================
+File: src/ai_service.cpp
+Purpose: Implements AIService. Work is posted to the worker thread with
+         QMetaObject::invokeMethod, so requests run one at a time in the
+         order they were made. Every request owns its own stop flag, which
+         means cancelling one search can never affect the next.
+================================================================================
+*/
+#include "ai_service.h"
+#include <algorithm>
+#include <thread>
+
+AIService::AIService(QObject* parent)
+    : QObject(parent),
+      workerContext(new QObject()),
+      nextRequestId(1),
+      activeRequestId(0) {
+    // Larger boards split each search across all cores. Safe to configure
+    // here because the worker thread has not started yet.
+    engine.setThreadCount(static_cast<int>(std::max(1u, std::thread::hardware_concurrency())));
+    workerContext->moveToThread(&workerThread);
+    connect(&workerThread, &QThread::finished, workerContext, &QObject::deleteLater);
+    workerThread.setObjectName("AIService");
+    workerThread.start();
+}
+
+AIService::~AIService() {
+    cancel();
+    workerThread.quit();
+    workerThread.wait();
+}
+
+int AIService::requestMove(const GameLogic& game, RequestKind kind) {
+    cancel();
+
+    const int requestId = nextRequestId++;
+    auto stopFlag = std::make_shared<std::atomic<bool>>(false);
+    activeStopFlag = stopFlag;
+    activeRequestId = requestId;
+
+    // The lambda owns its copy of the board, so the GUI is free to change
+    // gameLogic while the search runs.
+    QMetaObject::invokeMethod(workerContext, [this, game, kind, requestId, stopFlag]() mutable {
+        if (stopFlag->load()) return; // Cancelled while still queued.
+
+        engine.setStopFlag(stopFlag.get());
+        Move move = engine.getBestMove(game);
+        engine.setStopFlag(nullptr);
+        if (stopFlag->load()) return;
+
+        // Hop back to the GUI thread. If the service is gone by then, Qt
+        // drops the call because 'this' is the context object.
+        QMetaObject::invokeMethod(this, [this, kind, requestId, move]() {
+            if (requestId != activeRequestId) return; // Superseded meanwhile.
+            activeRequestId = 0;
+            activeStopFlag.reset();
+            emit moveReady(requestId, kind, move.row, move.col);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+
+    return requestId;
+}
+
+void AIService::cancel() {
+    if (activeStopFlag) {
+        activeStopFlag->store(true);
+        activeStopFlag.reset();
+    }
+    activeRequestId = 0;
+}
+
+void AIService::setDifficulty(int level) {
+    QMetaObject::invokeMethod(workerContext, [this, level]() {
+        engine.setDifficulty(level);
+    }, Qt::QueuedConnection);
+}
+
+void AIService::setTimeBudget(int milliseconds) {
+    QMetaObject::invokeMethod(workerContext, [this, milliseconds]() {
+        engine.setTimeBudget(std::chrono::milliseconds(milliseconds));
+    }, Qt::QueuedConnection);
+}
+
+bool AIService::isBusy() const {
+    return activeRequestId != 0;
+}
@@ -0,0 +1,231 @@
+/*
+================================================================================
+File: src/compact_game_store.cpp
+Purpose: Implements CompactGameStore. Every packed field is checked to
+         turn back into exactly the string it came from; a value that
+         wouldn't (an id with uppercase digits, a timestamp like Feb 30)
+         is interned instead.
+================================================================================
+*/
+#include "compact_game_store.h"
+#include "record_format.h"
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+constexpr std::uint8_t kResultMask = 0x03;
+constexpr std::uint8_t kAIOpponent = 0x04;
+constexpr std::uint8_t kTextTimestamp = 0x08;
+constexpr std::uint8_t kSpilledMoves = 0x10;
+// Two cells per byte; the packed length is then (count + 1) / 2.
+constexpr std::uint8_t kHalfByteMoves = 0x20;
+
+constexpr char kGameIdPrefix[] = "game-";
+constexpr std::size_t kGameIdPrefixLength = sizeof(kGameIdPrefix) - 1;
+// A packed game id keeps its digit count in the top four bits, so leading
+// zeros survive; a count of zero marks an interned id.
+constexpr int kMaxGameIdDigits = 15;
+constexpr int kDigitCountShift = 60;
+
+constexpr std::size_t kInlineMoveBytes = sizeof(std::uint64_t);
+
+bool packGameId(const std::string& id, std::uint64_t& key) {
+    const std::size_t digits = id.size() - kGameIdPrefixLength;
+    if (id.size() <= kGameIdPrefixLength || digits > kMaxGameIdDigits ||
+        id.compare(0, kGameIdPrefixLength, kGameIdPrefix) != 0) {
+        return false;
+    }
+    std::uint64_t value = 0;
+    for (std::size_t i = kGameIdPrefixLength; i < id.size(); ++i) {
+        const char c = id[i];
+        int digit;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else return false;
+        value = (value << 4) | static_cast<std::uint64_t>(digit);
+    }
+    key = (static_cast<std::uint64_t>(digits) << kDigitCountShift) | value;
+    return true;
+}
+
+std::string unpackGameId(std::uint64_t key) {
+    static const char kHex[] = "0123456789abcdef";
+    const int digits = static_cast<int>(key >> kDigitCountShift);
+    std::string id(kGameIdPrefix);
+    id.resize(kGameIdPrefixLength + digits);
+    for (int i = digits - 1; i >= 0; --i) {
+        id[kGameIdPrefixLength + i] = kHex[key & 0xF];
+        key >>= 4;
+    }
+    return id;
+}
+
+} // namespace
+
+void CompactGameStore::clear() {
+    ids.clear();
+    player1.clear();
+    player2.clear();
+    times.clear();
+    durations.clear();
+    moveData.clear();
+    moveCounts.clear();
+    boardSizes.clear();
+    winLengths.clear();
+    flags.clear();
+    moveArena.clear();
+    strings.clear();
+    stringIndex.clear();
+}
+
+void CompactGameStore::reserve(std::size_t games) {
+    ids.reserve(games);
+    player1.reserve(games);
+    player2.reserve(games);
+    times.reserve(games);
+    durations.reserve(games);
+    moveData.reserve(games);
+    moveCounts.reserve(games);
+    boardSizes.reserve(games);
+    winLengths.reserve(games);
+    flags.reserve(games);
+}
+
+std::size_t CompactGameStore::append(const GameState& game) {
+    const std::size_t slot = size();
+    ids.emplace_back();
+    player1.emplace_back();
+    player2.emplace_back();
+    times.emplace_back();
+    durations.emplace_back();
+    moveData.emplace_back();
+    moveCounts.emplace_back();
+    boardSizes.emplace_back();
+    winLengths.emplace_back();
+    flags.emplace_back();
+    store(slot, game);
+    return slot;
+}
+
+// A replaced game's spilled moves stay in the arena until clear().
+void CompactGameStore::replace(std::size_t slot, const GameState& game) {
+    store(slot, game);
+}
+
+void CompactGameStore::store(std::size_t slot, const GameState& game) {
+    std::uint64_t id;
+    if (!packGameId(game.gameId, id)) {
+        id = intern(game.gameId);
+    }
+    ids[slot] = id;
+    player1[slot] = intern(game.player1Id);
+    player2[slot] = intern(game.player2Id);
+    durations[slot] = game.durationSeconds;
+    boardSizes[slot] = static_cast<std::uint8_t>(game.boardSize);
+    winLengths[slot] = static_cast<std::uint8_t>(game.winLength);
+
+    std::uint8_t gameFlags = static_cast<std::uint8_t>(static_cast<int>(game.result) & kResultMask);
+    if (game.isAIOpponent) gameFlags |= kAIOpponent;
+    if (!record_format::parseTimestamp(game.timestamp, times[slot])) {
+        times[slot] = intern(game.timestamp);
+        gameFlags |= kTextTimestamp;
+    }
+
+    std::string packed;
+    record_format::packMoves(packed, game.moveHistory, game.boardSize);
+    moveCounts[slot] = static_cast<std::uint8_t>(game.moveHistory.size());
+    if (packed.size() != game.moveHistory.size()) gameFlags |= kHalfByteMoves;
+    if (packed.size() <= kInlineMoveBytes) {
+        std::uint64_t cells = 0;
+        std::memcpy(&cells, packed.data(), packed.size());
+        moveData[slot] = cells;
+    } else {
+        moveData[slot] = moveArena.size();
+        moveArena += packed;
+        gameFlags |= kSpilledMoves;
+    }
+    flags[slot] = gameFlags;
+}
+
+void CompactGameStore::get(std::size_t slot, GameState& game) const {
+    const std::uint64_t id = ids[slot];
+    game.gameId = (id >> kDigitCountShift) != 0 ? unpackGameId(id) : strings[static_cast<std::size_t>(id)];
+    game.player1Id = strings[player1[slot]];
+    game.player2Id = strings[player2[slot]];
+    game.durationSeconds = durations[slot];
+    game.boardSize = boardSizes[slot];
+    game.winLength = winLengths[slot];
+
+    const std::uint8_t gameFlags = flags[slot];
+    game.result = static_cast<GameResult>(gameFlags & kResultMask);
+    game.isAIOpponent = (gameFlags & kAIOpponent) != 0;
+    game.timestamp = (gameFlags & kTextTimestamp) ? strings[static_cast<std::size_t>(times[slot])]
+                                                  : record_format::formatTimestamp(times[slot]);
+
+    const int count = moveCounts[slot];
+    const std::size_t length = (gameFlags & kHalfByteMoves) ? static_cast<std::size_t>(count + 1) / 2 : count;
+    std::string_view packed;
+    std::uint64_t cells = moveData[slot];
+    if (gameFlags & kSpilledMoves) {
+        packed = std::string_view(moveArena.data() + cells, length);
+    } else {
+        packed = std::string_view(reinterpret_cast<const char*>(&cells), length);
+    }
+    if (!record_format::unpackMoves(packed, count, game.boardSize, game.moveHistory)) {
+        game.moveHistory.clear();
+    }
+}
+
+bool CompactGameStore::findGameKey(const std::string& gameId, std::uint64_t& key) const {
+    if (packGameId(gameId, key)) {
+        return true;
+    }
+    const auto found = stringIndex.find(gameId);
+    if (found == stringIndex.end()) {
+        return false;
+    }
+    key = found->second;
+    return true;
+}
+
+bool CompactGameStore::findPlayerKey(const std::string& playerId, std::uint32_t& key) const {
+    const auto found = stringIndex.find(playerId);
+    if (found == stringIndex.end()) {
+        return false;
+    }
+    key = found->second;
+    return true;
+}
+
+// A string's capacity never drops below what it holds inline, which is the
+// capacity of an empty one (15 characters with libstdc++ and MSVC, 22 with
+// libc++); anything larger was allocated.
+std::size_t CompactGameStore::heapBytes(const std::string& text) {
+    static const std::size_t inlineCapacity = std::string().capacity();
+    return text.capacity() > inlineCapacity ? text.capacity() + 1 : 0;
+}
+
+std::size_t CompactGameStore::memoryBytes() const {
+    std::size_t bytes = ids.capacity() * sizeof(std::uint64_t) + player1.capacity() * sizeof(std::uint32_t) +
+                        player2.capacity() * sizeof(std::uint32_t) + times.capacity() * sizeof(std::int64_t) +
+                        durations.capacity() * sizeof(std::int32_t) + moveData.capacity() * sizeof(std::uint64_t) +
+                        moveCounts.capacity() + boardSizes.capacity() + winLengths.capacity() + flags.capacity() +
+                        moveArena.capacity() + strings.capacity() * sizeof(std::string);
+    for (const auto& text : strings) {
+        // Each string is held twice: in the table and as the index's key.
+        bytes += 2 * heapBytes(text) + sizeof(std::pair<const std::string, std::uint32_t>) + sizeof(void*);
+    }
+    return bytes + stringIndex.bucket_count() * sizeof(void*);
+}
+
+std::uint32_t CompactGameStore::intern(const std::string& text) {
+    const auto found = stringIndex.find(text);
+    if (found != stringIndex.end()) {
+        return found->second;
+    }
+    const auto index = static_cast<std::uint32_t>(strings.size());
+    strings.push_back(text);
+    stringIndex.emplace(text, index);
+    return index;
+}
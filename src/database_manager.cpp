@@ -1,4 +1,11 @@
 #include "database_manager.h"
+#include "durable_file.h"
+#include "mapped_game_log.h"
+#include "record_format.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <sstream>
 #include <iostream>
 #include <filesystem>
@@ -6,7 +13,55 @@
 #include <sstream>
 #include <vector>
 
-DatabaseManager::DatabaseManager(std::string dbFilePath) : db_file_path_(dbFilePath) {
+namespace {
+
+// Each game log record is "<game fields>\t<crc32 as 8 hex digits>\n".
+constexpr char kChecksumSeparator = '\t';
+constexpr std::size_t kChecksumDigits = 8;
+
+// Compact once dead records are both numerous and at least a quarter of
+// the live ones, so the log never grows much past the history it holds.
+constexpr std::size_t kCompactionMinDeadRecords = 64;
+constexpr std::size_t kCompactionDeadRatio = 4;
+
+// forEachGame reads the log this many bytes at a time.
+constexpr std::size_t kStreamChunkBytes = 64 * 1024;
+
+// Smaller logs parse faster on one thread than the pool takes to wake up.
+constexpr std::size_t kParallelLoadMinBytes = 1024 * 1024;
+
+// The user journal is cleared once it grows past this.
+constexpr std::size_t kUserJournalCheckpointBytes = 64 * 1024;
+
+// First byte written over a text user record that has been replaced.
+constexpr char kUserTombstone = '#';
+
+std::size_t fileSize(const std::string& path) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    return error ? 0 : static_cast<std::size_t>(size);
+}
+
+char lastByte(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    char byte = 0;
+    if (file.is_open() && file.tellg() > 0) {
+        file.seekg(-1, std::ios::end);
+        file.get(byte);
+    }
+    return byte;
+}
+
+std::string frameRecord(const std::string& payload) {
+    char checksum[kChecksumDigits + 1];
+    std::snprintf(checksum, sizeof(checksum), "%08x", static_cast<unsigned>(record_format::crc32(payload.data(), payload.size())));
+    return payload + kChecksumSeparator + checksum + '\n';
+}
+
+} // namespace
+
+DatabaseManager::DatabaseManager(std::string dbFilePath)
+    : db_file_path_(dbFilePath), loadThreads(std::max(1u, std::thread::hardware_concurrency())) {
     // Create directory if it doesn't exist
    std::filesystem::path dir = std::filesystem::path(db_file_path_).parent_path();
     if (!dir.empty() && !std::filesystem::exists(dir)) {
@@ -18,42 +73,572 @@ DatabaseManager::~DatabaseManager() {
     // Clean up resources if needed
 }
 
+void DatabaseManager::setLoadThreads(int threads) {
+    loadThreads = std::max(1, threads);
+    if (loadPool && loadPool->size() != loadThreads) {
+        loadPool.reset();
+    }
+}
+
+bool DatabaseManager::hasFiles() const {
+    std::error_code error;
+    return std::filesystem::exists(usersFilePath(), error) || std::filesystem::exists(gamesFilePath(), error);
+}
+
 bool DatabaseManager::saveUsers(const std::unordered_map<std::string, UserProfile>& users) {
+    if (readOnly) {
+        return false;
+    }
     std::string serialized = serializeUsers(users);
-    return writeToFile(db_file_path_ + ".users", serialized);
+    if (!writeToFile(usersFilePath(), serialized)) {
+        return false;
+    }
+    // The new file supersedes the journal. A crash before the journal is
+    // removed only replays entries the file already holds.
+    std::error_code error;
+    std::filesystem::remove(userJournalPath(), error);
+    // Rebuild the record index from what was just written.
+    userIndexLoaded = false;
+    deserializeUsers(serialized);
+    return true;
 }
 
 std::unordered_map<std::string, UserProfile> DatabaseManager::loadUsers() {
-    std::string data = readFromFile(db_file_path_ + ".users");
-    return deserializeUsers(data);
+    std::string data = readFromFile(usersFilePath());
+    auto users = deserializeUsers(data);
+    if (record_format::headerVersion(data.data(), data.size(), record_format::kUsersMagic) > record_format::kVersion) {
+        // Written by a newer build; leave the file alone.
+        std::cerr << "User store uses an unsupported format version" << std::endl;
+        return users;
+    }
+    // Replay the journal: every entry is a complete profile, so applying
+    // them in order restores any update an in-place write may have torn.
+    if (replayUserJournal(users) > 0) {
+        userIndexLoaded = false;
+    }
+    // Text files from before fixed-width records, files in the other layout
+    // (the one-shot text-to-binary migration), files with a torn tail and
+    // replayed journals are rewritten once in the current layout.
+    if (!userIndexLoaded && !readOnly) {
+        saveUsers(users);
+    }
+    return users;
 }
 
-// Load all users, update or add this one, then save all
+// Overwrites this user's record in place, or appends it if it is new, so the
+// cost does not depend on how many accounts the file holds. The profile is
+// journaled (and synced) first, so a crash mid-write is repaired on load.
 bool DatabaseManager::saveUser(const UserProfile& user) {
-    auto users = loadUsers();
-    users[user.userId] = user;
-    return saveUsers(users);
+    if (readOnly) {
+        return false;
+    }
+    if (!userIndexLoaded) {
+        loadUsers();
+    }
+    std::string entry;
+    record_format::appendFrame(entry, record_format::encodeUser(user));
+    if (!durable_file::append(userJournalPath(), entry, syncWrites)) {
+        return false;
+    }
+    if (!writeUserRecord(user)) {
+        return false;
+    }
+    // Checkpoint: once the in-place writes are on disk the journal is no
+    // longer needed.
+    if (fileSize(userJournalPath()) >= kUserJournalCheckpointBytes &&
+        (!syncWrites || durable_file::sync(usersFilePath()))) {
+        std::error_code error;
+        std::filesystem::remove(userJournalPath(), error);
+    }
+    return true;
+}
+
+bool DatabaseManager::writeUserRecord(const UserProfile& user) {
+    const bool binary = storageFormat == StorageFormat::Binary;
+    const std::string record = binary ? record_format::encodeUser(user) : serializeUser(user);
+
+    std::fstream file(usersFilePath(), std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        // No file yet: create it.
+        std::unordered_map<std::string, UserProfile> users;
+        users[user.userId] = user;
+        return saveUsers(users);
+    }
+
+    auto existing = userIndex.find(user.userId);
+    if (existing != userIndex.end() && existing->second.length == record.size()) {
+        file.seekp(existing->second.offset);
+        file.write(record.data(), record.size());
+        file.flush();
+        return !file.fail();
+    }
+
+    // A new user, or one whose record changed length (e.g. a new username):
+    // retire the old record and append the new one.
+    if (existing != userIndex.end()) {
+        file.seekp(existing->second.offset);
+        file.put(binary ? static_cast<char>(record_format::kUserDead) : kUserTombstone);
+    }
+    file.seekp(0, std::ios::end);
+    const std::streamoff offset = file.tellp();
+    file.write(record.data(), record.size());
+    file.flush();
+    if (file.fail()) {
+        return false;
+    }
+    userIndex[user.userId] = UserRecordLocation{offset, record.size()};
+    return true;
+}
+
+std::size_t DatabaseManager::replayUserJournal(std::unordered_map<std::string, UserProfile>& users) {
+    const std::string journal = readFromFile(userJournalPath());
+    const char* p = journal.data();
+    const char* end = p + journal.size();
+    std::size_t replayed = 0;
+    while (p < end) {
+        const char* const frame = p;
+        std::string_view payload;
+        if (record_format::readFrame(p, end, payload) != record_format::FrameStatus::Ok) {
+            // Skip a damaged entry. If no intact one follows, this was the
+            // torn tail of a saveUser that never returned.
+            p = record_format::findFrame(frame + 1, end);
+            continue;
+        }
+        const char* entry = payload.data();
+        UserProfile user;
+        bool live = false;
+        if (record_format::decodeUser(entry, entry + payload.size(), user, live) && live) {
+            users[user.userId] = user;
+            replayed++;
+        }
+    }
+    return replayed;
+}
+
+std::string DatabaseManager::usersFilePath() const {
+    return db_file_path_ + ".users";
+}
+
+std::string DatabaseManager::userJournalPath() const {
+    return db_file_path_ + ".users.wal";
 }
 
 // part 2
+bool DatabaseManager::appendGames(const std::vector<GameState>& games) {
+    if (readOnly) {
+        return false;
+    }
+    const std::string path = gamesFilePath();
+    if (fileSize(path) > 0 && fileFormat(path, record_format::kGamesMagic) != storageFormat) {
+        // Convert the log first so one file never mixes both layouts.
+        loadGameHistory();
+    }
+
+    std::string records;
+    if (storageFormat == StorageFormat::Binary) {
+        if (fileSize(path) == 0) {
+            records = record_format::fileHeader(record_format::kGamesMagic);
+        }
+        for (const auto& game : games) {
+            record_format::appendGameRecord(records, game);
+        }
+    } else {
+        // A torn last line would run into the first new record; ending it
+        // here turns it into one bad line that loading skips.
+        if (fileSize(path) > 0 && lastByte(path) != '\n') {
+            records += '\n';
+        }
+        for (const auto& game : games) {
+            records += frameRecord(serializeGame(game));
+        }
+    }
+
+    // The log is its own journal: a synced append is durable, and a torn
+    // one is dropped by the next load.
+    if (!durable_file::append(path, records, syncWrites)) {
+        return false;
+    }
+    gameLogStats.liveRecords += games.size();
+    return true;
+}
+
 bool DatabaseManager::saveGameHistory(const std::vector<GameState>& games) {
-    std::string serialized = serializeGames(games);
-    return writeToFile(db_file_path_ + ".games", serialized);
+    if (readOnly) {
+        return false;
+    }
+    std::string serialized;
+    if (storageFormat == StorageFormat::Binary) {
+        serialized = record_format::fileHeader(record_format::kGamesMagic);
+        for (const auto& game : games) {
+            record_format::appendGameRecord(serialized, game);
+        }
+    } else {
+        for (const auto& game : games) {
+            serialized += frameRecord(serializeGame(game));
+        }
+    }
+    const auto closed = closeMappings();
+    const bool written = writeToFile(gamesFilePath(), serialized);
+    reopenMappings(closed);
+    if (!written) {
+        return false;
+    }
+    gameLogStats.liveRecords = games.size();
+    gameLogStats.deadRecords = 0;
+    return true;
 }
 
 std::vector<GameState> DatabaseManager::loadGameHistory() {
-    std::string data = readFromFile(db_file_path_ + ".games");
-    return deserializeGames(data);
+    const std::string data = readFromFile(gamesFilePath());
+    std::vector<GameState> games;
+    // Later records for the same game id supersede earlier ones.
+    std::unordered_map<std::string, std::size_t> indexById;
+    GameLogStats stats;
+    auto keep = [&](GameState&& game) {
+        auto existing = indexById.find(game.gameId);
+        if (existing != indexById.end()) {
+            games[existing->second] = std::move(game);
+            stats.deadRecords++;
+        } else {
+            indexById.emplace(game.gameId, games.size());
+            games.push_back(std::move(game));
+        }
+    };
+
+    const int version = record_format::headerVersion(data.data(), data.size(), record_format::kGamesMagic);
+    if (version > record_format::kVersion) {
+        // Written by a newer build; leave the file alone.
+        std::cerr << "Game history uses unsupported format version " << version << std::endl;
+        gameLogStats = stats;
+        return games;
+    }
+    const bool binary = version != 0;
+
+    std::size_t validEnd = binary ? record_format::kHeaderSize : 0;
+    for (ParsedChunk& chunk : parseGameLog(data, validEnd, data.size(), binary)) {
+        stats.deadRecords += chunk.deadRecords;
+        validEnd = std::max(validEnd, chunk.validEnd);
+        for (GameState& game : chunk.games) {
+            keep(std::move(game));
+        }
+    }
+    stats.liveRecords = games.size();
+
+    // Cut any torn or corrupt tail so the next append starts on a clean
+    // record. A damaged record with intact ones after it is only skipped.
+    if (validEnd < data.size() && !readOnly) {
+        std::error_code error;
+        const auto closed = closeMappings();
+        std::filesystem::resize_file(gamesFilePath(), validEnd, error);
+        reopenMappings(closed);
+        if (!error) {
+            stats.truncatedBytes = data.size() - validEnd;
+        }
+    }
+    gameLogStats = stats;
+
+    // Rewrite the log if it is in the other layout (the one-shot migration
+    // from text to binary) or carries too many dead records.
+    const bool otherFormat = !data.empty() && binary != (storageFormat == StorageFormat::Binary);
+    if (!readOnly && (otherFormat || (stats.deadRecords >= kCompactionMinDeadRecords &&
+                                      stats.deadRecords * kCompactionDeadRatio >= stats.liveRecords))) {
+        saveGameHistory(games);
+    }
+    return games;
 }
 
-//part 3
-bool DatabaseManager::writeToFile(const std::string& filename, const std::string& data) {
-    std::ofstream file(filename, std::ios::binary);
+// Splits the in-memory log into one piece per load thread and parses each
+// piece into its own chunk on the pool.
+// Merging the chunks in order gives the games back in file order. Logs
+// under kParallelLoadMinBytes are parsed as one piece on this thread.
+std::vector<DatabaseManager::ParsedChunk> DatabaseManager::parseGameLog(const std::string& data, std::size_t begin,
+                                                                        std::size_t end, bool binary) {
+    const std::size_t pieces =
+        end - begin >= kParallelLoadMinBytes ? static_cast<std::size_t>(loadThreads) : 1;
+    const std::size_t target = (end - begin) / pieces;
+
+    // Piece boundaries. Text records end at a newline. Binary pieces start
+    // at the plain byte offset: each piece but the first skips forward to
+    // its first intact frame, and every piece reads on past its end to
+    // finish the record it started there.
+    std::vector<std::size_t> bounds{begin};
+    if (binary) {
+        for (std::size_t i = 1; i < pieces; ++i) {
+            bounds.push_back(begin + i * target);
+        }
+    } else {
+        for (std::size_t i = 1; i < pieces; ++i) {
+            const std::size_t newline = data.find('\n', std::max(bounds.back(), begin + i * target));
+            if (newline == std::string::npos || newline + 1 >= end) {
+                break;
+            }
+            bounds.push_back(newline + 1);
+        }
+    }
+    bounds.push_back(end);
+
+    std::vector<ParsedChunk> chunks(bounds.size() - 1);
+    auto parse = [&](std::size_t index) {
+        if (binary) {
+            parseBinaryChunk(data, bounds[index], bounds[index + 1], index == 0, chunks[index]);
+        } else {
+            parseTextChunk(data, bounds[index], bounds[index + 1], chunks[index]);
+        }
+    };
+    if (chunks.size() == 1) {
+        parse(0);
+        return chunks;
+    }
+    if (!loadPool) {
+        loadPool = std::make_unique<ThreadPool>(loadThreads);
+    }
+    const std::size_t threads = static_cast<std::size_t>(loadPool->size());
+    loadPool->run([&](int thread) {
+        for (std::size_t index = static_cast<std::size_t>(thread); index < chunks.size(); index += threads) {
+            parse(index);
+        }
+    });
+    return chunks;
+}
+
+void DatabaseManager::parseTextChunk(const std::string& data, std::size_t begin, std::size_t end,
+                                     ParsedChunk& chunk) {
+    std::size_t pos = begin;
+    while (pos < end) {
+        const std::size_t newline = data.find('\n', pos);
+        if (newline == std::string::npos || newline >= end) {
+            break; // Torn tail: the append never wrote its newline.
+        }
+        std::string line = data.substr(pos, newline - pos);
+        pos = newline + 1;
+        if (line.empty()) {
+            chunk.validEnd = pos;
+            continue;
+        }
+
+        GameState game;
+        bool legacy = false;
+        if (!parseRecordLine(line, game, legacy)) {
+            chunk.deadRecords++;
+            continue;
+        }
+        chunk.validEnd = pos;
+        if (legacy) {
+            chunk.deadRecords++; // Live, but rewritten with a checksum on compaction.
+        }
+        chunk.games.push_back(std::move(game));
+    }
+}
+
+void DatabaseManager::parseBinaryChunk(const std::string& data, std::size_t begin, std::size_t end, bool aligned,
+                                       ParsedChunk& chunk) {
+    const char* const first = data.data();
+    const char* const last = first + data.size();
+    const char* p = aligned ? first + begin : record_format::findFrame(first + begin, last);
+    while (p < first + end) {
+        const char* const record = p;
+        GameState game;
+        if (record_format::readGameRecord(p, last, game) == record_format::FrameStatus::Ok) {
+            chunk.validEnd = static_cast<std::size_t>(p - first);
+            chunk.games.push_back(std::move(game));
+            continue;
+        }
+        // Skip to the next intact record. Only if there is none was this
+        // the torn tail of an interrupted append.
+        p = record_format::findFrame(record + 1, last);
+        if (p == last) {
+            break;
+        }
+        chunk.deadRecords++;
+    }
+}
+
+// Reads the log a chunk at a time and parses each complete record as soon as
+// it is in the buffer; a record split across chunks waits for the next one.
+// Memory use is one chunk plus one record, whatever the size of the log.
+void DatabaseManager::forEachGame(const std::function<bool(const GameState&)>& visit) {
+    std::ifstream file(gamesFilePath(), std::ios::binary);
     if (!file.is_open()) {
+        return;
+    }
+    std::string buffer;
+    std::size_t consumed = 0;
+    bool atEnd = false;
+    auto refill = [&] {
+        buffer.erase(0, consumed);
+        consumed = 0;
+        const std::size_t kept = buffer.size();
+        buffer.resize(kept + kStreamChunkBytes);
+        file.read(&buffer[kept], static_cast<std::streamsize>(kStreamChunkBytes));
+        buffer.resize(kept + static_cast<std::size_t>(file.gcount()));
+        atEnd = file.gcount() == 0;
+    };
+
+    refill();
+    const int version = record_format::headerVersion(buffer.data(), buffer.size(), record_format::kGamesMagic);
+    if (version > record_format::kVersion) {
+        return;
+    }
+    if (version != 0) {
+        consumed = record_format::kHeaderSize;
+        while (true) {
+            const char* const record = buffer.data() + consumed;
+            const char* const bufferEnd = buffer.data() + buffer.size();
+            if (record == bufferEnd && atEnd) {
+                return;
+            }
+            const char* p = record;
+            GameState game;
+            const auto status = record_format::readGameRecord(p, bufferEnd, game);
+            if (status == record_format::FrameStatus::Ok) {
+                consumed = static_cast<std::size_t>(p - buffer.data());
+                if (!visit(game)) return;
+                continue;
+            }
+            // Lengths are capped (kMaxFrameBytes), so waiting for the rest
+            // of a record never holds more than one record past the chunk.
+            if (status == record_format::FrameStatus::Truncated && !atEnd) {
+                refill();
+                continue;
+            }
+            // A damaged record, or one that runs past the end of the file:
+            // try each following byte until an intact record starts. Past a
+            // torn tail none does.
+            consumed++;
+        }
+    }
+    while (true) {
+        const std::size_t newline = buffer.find('\n', consumed);
+        if (newline == std::string::npos) {
+            if (atEnd) return; // Torn tail, or the end of the log.
+            refill();
+            continue;
+        }
+        std::string line = buffer.substr(consumed, newline - consumed);
+        consumed = newline + 1;
+        GameState game;
+        bool legacy = false;
+        if (!line.empty() && parseRecordLine(line, game, legacy) && !visit(game)) {
+            return;
+        }
+    }
+}
+
+std::shared_ptr<const MappedGameLog> DatabaseManager::mapGameHistory() {
+    if (storageFormat != StorageFormat::Binary) {
+        return nullptr;
+    }
+    auto log = std::make_shared<MappedGameLog>();
+    if (!log->open(gamesFilePath()) || log->hasTornTail()) {
+        // A text log (migrated here) or a torn tail (trimmed here) goes
+        // through the full loader once; the repaired file is then mapped.
+        log.reset();
+        if (fileSize(gamesFilePath()) == 0) {
+            return nullptr;
+        }
+        loadGameHistory();
+        log = std::make_shared<MappedGameLog>();
+        if (!log->open(gamesFilePath())) {
+            return nullptr;
+        }
+    }
+    gameLogStats = GameLogStats();
+    gameLogStats.liveRecords = log->size();
+    std::lock_guard<std::mutex> lock(mappingsMutex);
+    mappings.erase(std::remove_if(mappings.begin(), mappings.end(),
+                                  [](const std::weak_ptr<MappedGameLog>& mapping) { return mapping.expired(); }),
+                   mappings.end());
+    mappings.push_back(log);
+    return log;
+}
+
+std::vector<std::shared_ptr<MappedGameLog>> DatabaseManager::closeMappings() {
+    std::vector<std::shared_ptr<MappedGameLog>> closed;
+    std::lock_guard<std::mutex> lock(mappingsMutex);
+    for (const auto& mapping : mappings) {
+        if (auto log = mapping.lock()) {
+            log->close();
+            closed.push_back(std::move(log));
+        }
+    }
+    return closed;
+}
+
+void DatabaseManager::reopenMappings(const std::vector<std::shared_ptr<MappedGameLog>>& closed) {
+    for (const auto& log : closed) {
+        log->reopen();
+    }
+}
+
+bool DatabaseManager::compactGameLog() {
+    return saveGameHistory(loadGameHistory());
+}
+
+bool DatabaseManager::loadUser(const std::string& userId, UserProfile& user) {
+    const auto users = loadUsers();
+    const auto found = users.find(userId);
+    if (found == users.end()) {
         return false;
     }
-    file.write(data.c_str(), data.size());
-    return !file.fail();
+    user = found->second;
+    return true;
+}
+
+std::vector<GameState> DatabaseManager::loadUserGames(const std::string& userId) {
+    std::vector<GameState> userGames;
+    for (auto& game : loadGameHistory()) {
+        if (game.player1Id == userId || game.player2Id == userId) {
+            userGames.push_back(std::move(game));
+        }
+    }
+    // Newest first, with ties in reverse save order (see storage_backend.h).
+    std::reverse(userGames.begin(), userGames.end());
+    std::stable_sort(userGames.begin(), userGames.end(),
+                     [](const GameState& a, const GameState& b) { return a.timestamp > b.timestamp; });
+    return userGames;
+}
+
+bool DatabaseManager::loadGame(const std::string& gameId, GameState& game) {
+    for (auto& candidate : loadGameHistory()) {
+        if (candidate.gameId == gameId) {
+            game = std::move(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t DatabaseManager::countGames() {
+    return loadGameHistory().size();
+}
+
+bool DatabaseManager::writeBatch(const std::unordered_map<std::string, UserProfile>& users,
+                                 const std::vector<GameState>& games) {
+    bool ok = true;
+    for (const auto& pair : users) {
+        ok = saveUser(pair.second) && ok;
+    }
+    return (games.empty() || appendGames(games)) && ok;
+}
+
+std::string DatabaseManager::gamesFilePath() const {
+    return db_file_path_ + ".games";
+}
+
+DatabaseManager::StorageFormat DatabaseManager::fileFormat(const std::string& path, const char (&magic)[4]) const {
+    char header[record_format::kHeaderSize];
+    std::ifstream file(path, std::ios::binary);
+    file.read(header, sizeof(header));
+    return record_format::headerVersion(header, static_cast<std::size_t>(file.gcount()), magic) != 0
+               ? StorageFormat::Binary
+               : StorageFormat::Text;
+}
+
+//part 3
+// Whole-file writes never truncate the target in place: a crash part-way
+// through leaves the previous contents intact.
+bool DatabaseManager::writeToFile(const std::string& filename, const std::string& data) {
+    return durable_file::writeAtomically(filename, data, syncWrites);
 }
 
 std::string DatabaseManager::readFromFile(const std::string& filename) {
@@ -61,30 +646,80 @@ std::string DatabaseManager::readFromFile(const std::string& filename) {
     if (!file.is_open()) {
         return "";
     }
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    // Read straight into a string of the right size rather than going
+    // through a stringstream, which would copy everything twice.
+    std::string data(fileSize(filename), '\0');
+    file.read(&data[0], static_cast<std::streamsize>(data.size()));
+    data.resize(static_cast<std::size_t>(file.gcount()));
+    return data;
 }
 
 std::string DatabaseManager::serializeUsers(const std::unordered_map<std::string, UserProfile>& users) {
-    std::stringstream ss;
+    std::string serialized;
+    if (storageFormat == StorageFormat::Binary) {
+        serialized = record_format::fileHeader(record_format::kUsersMagic);
+        for (const auto& pair : users) {
+            serialized += record_format::encodeUser(pair.second);
+        }
+        return serialized;
+    }
     for (const auto& pair : users) {
-        const UserProfile& user = pair.second;
-        ss << user.userId << "|" << user.username << "|" << user.passwordHash
-           << "|" << user.gamesPlayed << "|" << user.gamesWon << "|" << user.gamesLost
-           << "|" << user.gamesTied << "|" << user.totalGameTimeSeconds 
-           << "|" << user.currentWinStreak << "|" << user.longestWinStreak
-           << "|" << user.aiGamesPlayed << "|" << user.pvpGamesPlayed << "\n";
+        serialized += serializeUser(pair.second);
     }
-    return ss.str();
+    return serialized;
+}
+
+// Counters are zero-padded to a fixed width, so a record keeps its length
+// as the stats change and saveUser can overwrite it where it stands.
+std::string DatabaseManager::serializeUser(const UserProfile& user) {
+    char stats[160];
+    std::snprintf(stats, sizeof(stats), "%010d|%010d|%010d|%010d|%019lld|%010d|%010d|%010d|%010d",
+                  user.gamesPlayed, user.gamesWon, user.gamesLost, user.gamesTied,
+                  user.totalGameTimeSeconds, user.currentWinStreak, user.longestWinStreak,
+                  user.aiGamesPlayed, user.pvpGamesPlayed);
+    return user.userId + "|" + user.username + "|" + user.passwordHash + "|" + stats + "\n";
 }
 
 //part 4
 std::unordered_map<std::string, UserProfile> DatabaseManager::deserializeUsers(const std::string& data) {
     std::unordered_map<std::string, UserProfile> users;
-    std::stringstream ss(data);
-    std::string line;
-    while (std::getline(ss, line)) {
+    userIndex.clear();
+
+    const int version = record_format::headerVersion(data.data(), data.size(), record_format::kUsersMagic);
+    if (version != 0) {
+        const char* begin = data.data();
+        const char* p = begin + record_format::kHeaderSize;
+        const char* end = begin + data.size();
+        bool intact = version == record_format::kVersion;
+        while (intact && p < end) {
+            const char* record = p;
+            UserProfile u;
+            bool live = false;
+            if (!record_format::decodeUser(p, end, u, live)) {
+                intact = false; // Torn tail; loadUsers rewrites the file.
+                break;
+            }
+            if (live) {
+                userIndex[u.userId] = UserRecordLocation{record - begin, static_cast<std::size_t>(p - record)};
+                users[u.userId] = u;
+            }
+        }
+        userIndexLoaded = intact && storageFormat == StorageFormat::Binary;
+        return users;
+    }
+
+    bool fixedWidth = true;
+    std::size_t pos = 0;
+    while (pos < data.size()) {
+        std::size_t end = data.find('\n', pos);
+        if (end == std::string::npos) end = data.size();
+        const std::size_t offset = pos;
+        std::string line = data.substr(pos, end - pos);
+        pos = end + 1;
+        if (line.empty() || line[0] == kUserTombstone) {
+            continue;
+        }
+
         std::stringstream lineStream(line);
         std::string segment;
         UserProfile u;
@@ -111,89 +746,105 @@ std::unordered_map<std::string, UserProfile> DatabaseManager::deserializeUsers(c
             field++;
         }
         if (!u.userId.empty()) {
+            const std::size_t length = end - offset + 1;
+            fixedWidth = fixedWidth && serializeUser(u) == data.substr(offset, length);
+            userIndex[u.userId] = UserRecordLocation{static_cast<std::streamoff>(offset), length};
             users[u.userId] = u;
         }
     }
+    userIndexLoaded = fixedWidth && storageFormat == StorageFormat::Text;
     return users;
 }
 
-std::string DatabaseManager::serializeGames(const std::vector<GameState>& games) {
+std::string DatabaseManager::serializeGame(const GameState& game) {
     std::stringstream ss;
-    for (const auto& game : games) {
-        ss << game.gameId << "|"
-           << game.player1Id << "|"
-           << game.player2Id << "|"
-           << (game.isAIOpponent ? "1" : "0") << "|"
-           << static_cast<int>(game.result) << "|"
-           << game.timestamp << "|";
-        
-        for (size_t i = 0; i < game.moveHistory.size(); ++i) {
-            if (i > 0) ss << ";";
-            ss << game.moveHistory[i].row << "," << game.moveHistory[i].col;
-        }
-        ss << "\n";
+    ss << game.gameId << "|"
+       << game.player1Id << "|"
+       << game.player2Id << "|"
+       << (game.isAIOpponent ? "1" : "0") << "|"
+       << static_cast<int>(game.result) << "|"
+       << game.timestamp << "|";
+
+    for (size_t i = 0; i < game.moveHistory.size(); ++i) {
+        if (i > 0) ss << ";";
+        ss << game.moveHistory[i].row << "," << game.moveHistory[i].col;
+    }
+    // Classic games keep the original line format; other variants add
+    // their geometry as a trailing "|size,winLength" field.
+    if (game.boardSize != GameLogic::kClassicBoardSize || game.winLength != GameLogic::kClassicBoardSize) {
+        ss << "|" << game.boardSize << "," << game.winLength;
     }
     return ss.str();
 }
 
-std::vector<GameState> DatabaseManager::deserializeGames(const std::string& data) {
-    std::vector<GameState> games;
-    std::stringstream ss(data);
-    std::string line;
-
-    while (std::getline(ss, line)) {
-        if (line.empty()) {
-            continue; 
+// Framed records must match their checksum. Lines without one are from the
+// old whole-file format and are taken as they are.
+bool DatabaseManager::parseRecordLine(std::string& line, GameState& game, bool& legacy) {
+    const std::size_t separator = line.rfind(kChecksumSeparator);
+    legacy = separator == std::string::npos;
+    if (!legacy) {
+        const std::string checksum = line.substr(separator + 1);
+        line.resize(separator);
+        char expected[kChecksumDigits + 1];
+        std::snprintf(expected, sizeof(expected), "%08x",
+                      static_cast<unsigned>(record_format::crc32(line.data(), line.size())));
+        if (checksum != expected) {
+            return false;
         }
+    }
+    return parseGame(line, game);
+}
 
-        std::stringstream lineStream(line);
-        std::string field;
-        GameState game;
+bool DatabaseManager::parseGame(const std::string& line, GameState& game) {
+    std::stringstream lineStream(line);
+    std::string field;
 
+    try {
 
-        try {
+        if (!std::getline(lineStream, field, '|')) return false;
+        game.gameId = field;
 
-            if (!std::getline(lineStream, field, '|')) continue;
-            game.gameId = field;
+        if (!std::getline(lineStream, field, '|')) return false;
+        game.player1Id = field;
 
-            if (!std::getline(lineStream, field, '|')) continue;
-            game.player1Id = field;
+        if (!std::getline(lineStream, field, '|')) return false;
+        game.player2Id = field;
 
-            if (!std::getline(lineStream, field, '|')) continue;
-            game.player2Id = field;
+        if (!std::getline(lineStream, field, '|')) return false;
+        game.isAIOpponent = (field == "1");
 
-            if (!std::getline(lineStream, field, '|')) continue;
-            game.isAIOpponent = (field == "1");
+        if (!std::getline(lineStream, field, '|')) return false;
+        game.result = static_cast<GameResult>(std::stoi(field));
 
-            if (!std::getline(lineStream, field, '|')) continue;
-            game.result = static_cast<GameResult>(std::stoi(field));
+        if (!std::getline(lineStream, field, '|')) return false;
+        game.timestamp = field;
 
-            if (!std::getline(lineStream, field, '|')) continue;
-            game.timestamp = field;
+        if (std::getline(lineStream, field, '|')) {
+            std::stringstream movesStream(field);
+            std::string movePair;
 
-            if (std::getline(lineStream, field)) {
-                std::stringstream movesStream(field);
-                std::string movePair;
+            while (std::getline(movesStream, movePair, ';')) {
+                if (movePair.empty()) continue;
+                size_t commaPos = movePair.find(',');
+                if (commaPos != std::string::npos) {
+                    std::string rowStr = movePair.substr(0, commaPos);
+                    std::string colStr = movePair.substr(commaPos + 1);
 
-                while (std::getline(movesStream, movePair, ';')) {
-                    if (movePair.empty()) continue; 
-                    size_t commaPos = movePair.find(',');
-                    if (commaPos != std::string::npos) {
-                        std::string rowStr = movePair.substr(0, commaPos);
-                        std::string colStr = movePair.substr(commaPos + 1);
-                        
-                        game.moveHistory.emplace_back(std::stoi(rowStr), std::stoi(colStr));
-                    }
+                    game.moveHistory.emplace_back(std::stoi(rowStr), std::stoi(colStr));
                 }
             }
-        } catch (const std::exception& e) {
-            std::cerr << "Failed to parse game history line: " << line << " | Error: " << e.what() << std::endl;
-            continue;
         }
 
-        games.push_back(game);
+        if (std::getline(lineStream, field) && !field.empty()) {
+            size_t commaPos = field.find(',');
+            if (commaPos != std::string::npos) {
+                game.boardSize = std::stoi(field.substr(0, commaPos));
+                game.winLength = std::stoi(field.substr(commaPos + 1));
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse game history line: " << line << " | Error: " << e.what() << std::endl;
+        return false;
     }
-    return games;
+    return true;
 }
-
-
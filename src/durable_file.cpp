@@ -0,0 +1,112 @@
+/*
+================================================================================
+File: src/durable_file.cpp
+Purpose: Implements the durable_file primitives on POSIX file descriptors
+         (fsync), with the equivalent MSVC CRT calls (_commit) on Windows.
+         std::filesystem::rename replaces the target atomically on both.
+================================================================================
+*/
+#include "durable_file.h"
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+int openFile(const std::string& path, int flags) { return _open(path.c_str(), flags | _O_BINARY, _S_IREAD | _S_IWRITE); }
+int closeFile(int fd) { return _close(fd); }
+int syncFd(int fd) { return _commit(fd); }
+long long writeFd(int fd, const char* data, std::size_t size) { return _write(fd, data, static_cast<unsigned>(size)); }
+#else
+int openFile(const std::string& path, int flags) { return ::open(path.c_str(), flags, 0644); }
+int closeFile(int fd) { return ::close(fd); }
+int syncFd(int fd) { return ::fsync(fd); }
+long long writeFd(int fd, const char* data, std::size_t size) { return ::write(fd, data, size); }
+#endif
+
+bool writeAll(int fd, const std::string& data) {
+    std::size_t written = 0;
+    while (written < data.size()) {
+        const long long n = writeFd(fd, data.data() + written, data.size() - written);
+        if (n <= 0) return false;
+        written += static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+// Makes a completed rename durable. Directories can't be opened for
+// syncing on Windows, where NTFS journals the rename itself.
+void syncDirectory(const std::string& path) {
+#ifndef _WIN32
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    if (dir.empty()) dir = ".";
+    const int fd = ::open(dir.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+} // namespace
+
+bool durable_file::writeAtomically(const std::string& path, const std::string& data, bool sync) {
+    const std::string tempPath = path + ".tmp";
+    const int fd = openFile(tempPath, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = writeAll(fd, data) && (!sync || syncFd(fd) == 0);
+    closeFile(fd);
+    std::error_code error;
+    if (!ok) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        // The target is left as it was, e.g. when another process has it
+        // open on Windows.
+        std::cerr << "Could not replace " << path << ": " << error.message() << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    if (sync) {
+        syncDirectory(path);
+    }
+    return true;
+}
+
+bool durable_file::append(const std::string& path, const std::string& data, bool sync) {
+    const int fd = openFile(path, O_WRONLY | O_CREAT | O_APPEND);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = writeAll(fd, data) && (!sync || syncFd(fd) == 0);
+    closeFile(fd);
+    return ok;
+}
+
+bool durable_file::sync(const std::string& path) {
+#ifdef _WIN32
+    const int fd = openFile(path, O_RDWR);
+#else
+    const int fd = openFile(path, O_RDONLY);
+#endif
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = syncFd(fd) == 0;
+    closeFile(fd);
+    return ok;
+}
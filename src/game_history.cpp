@@ -1,19 +1,35 @@
-// In game_history.cpp, please replace the existing file content with this new version.
+/*
+================================================================================
+File: src/game_history.cpp
+Purpose: Implements GameHistory: games saved this session, the stored games
+         kept in memory, and the indexes that find a user's games or a game
+         by id, whether it is held, in a mapped log, in a stream or behind
+         an indexed backend.
+================================================================================
+*/
 
 #include "game_history.h"
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
-#include "database_manager.h" // Keep this include
+#include <deque>
+#include <iterator>
+#include <string_view>
+#include "storage_backend.h"
+#include "mapped_game_log.h"
 
 GameHistory::GameHistory() {}
 
+GameHistory::~GameHistory() {
+    dropUserGames();
+}
+
 // MODIFIED: This function now ONLY adds the game to the in-memory list.
 // It no longer calls the database manager.
 std::string GameHistory::saveGame(const std::string& player1Id, const std::string& player2Id,
                         bool isAIOpponent, const std::vector<Move>& moves,
-                        GameResult result) {
+                        GameResult result, int boardSize, int winLength) {
     GameState newGame;
     newGame.gameId = generateGameId();
     newGame.player1Id = player1Id;
@@ -22,59 +38,374 @@ std::string GameHistory::saveGame(const std::string& player1Id, const std::strin
     newGame.moveHistory = moves;
     newGame.result = result;
     newGame.timestamp = getCurrentTimestamp();
+    newGame.boardSize = boardSize;
+    newGame.winLength = winLength;
     // newGame.durationSeconds is not set here as it's not passed in.
     // It will keep its default value of 0 unless set elsewhere.
 
-    gameHistory.push_back(newGame);
-    return newGame.gameId;
+    gameHistory.push_back(std::move(newGame));
+    indexGame(gameHistory.back());
+    return gameHistory.back().gameId;
 }
 
-// This function now correctly loads the history from the file into the class member.
-void GameHistory::loadFromDatabase(DatabaseManager& dbManager) {
-    gameHistory = dbManager.loadGameHistory();
+void GameHistory::loadFromDatabase(StorageBackend& storage, std::size_t eagerGames) {
+    gameHistory.clear();
+    archive.reset();
+    database = nullptr;
+    loadedGames.clear();
+    eagerStore.clear();
+    olderGames = nullptr;
+    storedGameCount = 0;
+    firstEager = 0;
+    gamesById.clear();
+    dropUserGames();
+    fetchedUsers.clear();
+    storedByUser.clear();
+    storedIds.clear();
+    archiveIndexed = false;
+    if (storage.hasIndexedLookups()) {
+        database = &storage;
+        return;
+    }
+    archive = storage.mapGameHistory();
+    if (archive) {
+        indexArchive();
+        return;
+    }
+    // The newest games are kept in two blocks of up to 'eagerGames' each,
+    // so the window slides without holding more than twice that.
+    CompactGameStore previous;
+    CompactGameStore current;
+    storage.forEachGame([&](const GameState& game) {
+        storedIds.push_back(storedIdEntry(game.gameId, storedGameCount));
+        indexStoredRecord(game.player1Id, game.player2Id, storedGameCount);
+        storedGameCount++;
+        if (eagerGames > 0) {
+            if (current.size() == eagerGames) {
+                previous = std::move(current);
+                current.clear();
+            }
+            current.append(game);
+        }
+        return true;
+    });
+    const std::size_t fromPrevious = std::min(previous.size(), eagerGames - current.size());
+    eagerStore.reserve(fromPrevious + current.size());
+    GameState game;
+    for (std::size_t slot = previous.size() - fromPrevious; slot < previous.size(); ++slot) {
+        previous.get(slot, game);
+        eagerStore.append(game);
+    }
+    for (std::size_t slot = 0; slot < current.size(); ++slot) {
+        current.get(slot, game);
+        eagerStore.append(game);
+    }
+    firstEager = storedGameCount - eagerStore.size();
+    if (firstEager > 0) {
+        olderGames = &storage;
+    }
+    std::sort(storedIds.begin(), storedIds.end());
 }
 
-// NEW FUNCTION: This gives other classes a way to get the full list for saving.
-const std::vector<GameState>& GameHistory::getAllGames() const {
-    return gameHistory;
+std::uint64_t GameHistory::storedIdEntry(std::string_view gameId, std::size_t record) {
+    const auto hash = static_cast<std::uint32_t>(std::hash<std::string_view>()(gameId));
+    return (static_cast<std::uint64_t>(hash) << 32) | static_cast<std::uint32_t>(record);
 }
 
-std::vector<GameState> GameHistory::getUserGames(const std::string& userId) {
-    std::vector<GameState> userGames;
+// Users already fetched hold their games; they only come up again when a
+// rewritten archive is indexed anew.
+void GameHistory::indexStoredRecord(std::string_view player1Id, std::string_view player2Id,
+                                    std::size_t record) {
+    auto add = [&](std::string_view player) {
+        std::string userId(player);
+        if (fetchedUsers.count(userId) == 0) {
+            storedByUser[std::move(userId)].push_back(static_cast<std::uint32_t>(record));
+        }
+    };
+    add(player1Id);
+    if (player2Id != player1Id) {
+        add(player2Id);
+    }
+}
 
-    for (const auto& game : gameHistory) {
-        if (game.player1Id == userId || game.player2Id == userId) {
-            userGames.push_back(game);
+// Ids are read in place; nothing is materialized here. A rewritten archive
+// (see MappedGameLog::reopen) may have renumbered its records.
+void GameHistory::indexArchive() {
+    const auto reading = archive->lockForReading();
+    if (archiveIndexed && archiveGeneration == archive->generation()) {
+        return;
+    }
+    storedByUser.clear();
+    storedIds.clear();
+    storedIds.reserve(archive->size());
+    record_format::GameRecordView view;
+    for (std::size_t i = 0; i < archive->size(); ++i) {
+        if (archive->view(i, view)) {
+            storedIds.push_back(storedIdEntry(view.gameId, i));
+            indexStoredRecord(view.player1Id, view.player2Id, i);
         }
     }
+    std::sort(storedIds.begin(), storedIds.end());
+    archiveIndexed = true;
+    archiveGeneration = archive->generation();
+}
 
-    std::sort(userGames.begin(), userGames.end(),
-              [](const GameState& a, const GameState& b) {
-                  return a.timestamp > b.timestamp;
-              });
+void GameHistory::indexGame(const GameState& game) {
+    auto entry = gamesById.try_emplace(game.gameId, &game);
+    if (!entry.second) {
+        // A later record of the same game supersedes the earlier one.
+        const GameState* earlier = entry.first->second;
+        for (const std::string* userId : {&earlier->player1Id, &earlier->player2Id}) {
+            auto user = gamesByUser.find(*userId);
+            if (user != gamesByUser.end()) {
+                auto& games = user->second->games;
+                games.erase(std::remove(games.begin(), games.end(), earlier), games.end());
+                user->second->generation++;
+            }
+        }
+        entry.first->second = &game;
+    }
+    indexUserGame(game.player1Id, game);
+    if (game.player2Id != game.player1Id) {
+        indexUserGame(game.player2Id, game);
+    }
+}
+
+// Games almost always arrive newest last, so this is usually an append,
+// which ranges over the list survive.
+void GameHistory::indexUserGame(const std::string& userId, const GameState& game) {
+    auto& list = gamesByUser[userId];
+    if (!list) {
+        list = std::make_shared<UserGameList>();
+    }
+    auto& games = list->games;
+    auto position = std::upper_bound(games.begin(), games.end(), game.timestamp,
+                                     [](const std::string& timestamp, const GameState* other) {
+                                         return timestamp < other->timestamp;
+                                     });
+    if (position != games.end()) {
+        list->generation++;
+    }
+    games.insert(position, &game);
+}
 
-    return userGames;
+// Ranges still held keep their list alive, but not the games it points to.
+void GameHistory::dropUserGames() {
+    for (auto& user : gamesByUser) {
+        user.second->games.clear();
+        user.second->generation++;
+    }
+    gamesByUser.clear();
 }
 
-GameState GameHistory::getGameById(const std::string& gameId) {
-    for (const auto& game : gameHistory) {
-        if (game.gameId == gameId) {
-            return game;
+// Only the user's own list is updated: the opponent's picks the same
+// copies up through the id index once theirs is fetched.
+void GameHistory::fetchStoredGames(const std::string& userId) {
+    auto& list = gamesByUser[userId];
+    if (!list) {
+        list = std::make_shared<UserGameList>();
+    }
+    auto& userGames = list->games;
+    std::unordered_set<const GameState*> held(userGames.begin(), userGames.end());
+
+    // A later record of the same game supersedes an earlier one.
+    std::vector<GameState> stored;
+    std::unordered_map<std::string, std::size_t> indexById;
+    auto keep = [&](GameState&& game) {
+        auto existing = indexById.find(game.gameId);
+        if (existing != indexById.end()) {
+            stored[existing->second] = std::move(game);
+        } else {
+            indexById.emplace(game.gameId, stored.size());
+            stored.push_back(std::move(game));
+        }
+    };
+    if (database) {
+        for (GameState& game : database->loadUserGames(userId)) {
+            keep(std::move(game));
         }
+    } else if (auto records = storedByUser.find(userId); records != storedByUser.end()) {
+        // Only the user's own records are read. Their players are checked
+        // again in case the log was rewritten in between.
+        const std::vector<std::uint32_t>& wanted = records->second;
+        if (archive) {
+            const auto reading = archive->lockForReading();
+            record_format::GameRecordView view;
+            for (const std::uint32_t record : wanted) {
+                if (archive->view(record, view) && (view.player1Id == userId || view.player2Id == userId)) {
+                    GameState game;
+                    record_format::materializeGame(view, game);
+                    keep(std::move(game));
+                }
+            }
+        } else {
+            // A stream can't skip ahead, but it stops at the user's last
+            // record before the eager window, if there is one.
+            const auto eager = std::lower_bound(wanted.begin(), wanted.end(), firstEager);
+            const std::size_t older = static_cast<std::size_t>(eager - wanted.begin());
+            if (older > 0) {
+                std::size_t position = 0;
+                std::size_t next = 0;
+                olderGames->forEachGame([&](const GameState& game) {
+                    if (position++ == wanted[next]) {
+                        if (game.player1Id == userId || game.player2Id == userId) {
+                            keep(GameState(game));
+                        }
+                        next++;
+                    }
+                    return next < older;
+                });
+            }
+            for (auto record = eager; record != wanted.end(); ++record) {
+                GameState game;
+                eagerStore.get(*record - firstEager, game);
+                keep(std::move(game));
+            }
+        }
+        storedByUser.erase(records);
+    }
+
+    // Games already held (saved this session, or fetched for the opponent
+    // or by id) are kept rather than copied again.
+    std::vector<const GameState*> added;
+    for (auto& game : stored) {
+        auto existing = gamesById.find(game.gameId);
+        if (existing == gamesById.end()) {
+            loadedGames.push_back(std::move(game));
+            gamesById.emplace(loadedGames.back().gameId, &loadedGames.back());
+            added.push_back(&loadedGames.back());
+        } else if (held.insert(existing->second).second) {
+            added.push_back(existing->second);
+        }
+    }
+    auto byTime = [](const GameState* a, const GameState* b) { return a->timestamp < b->timestamp; };
+    std::stable_sort(added.begin(), added.end(), byTime);
+    std::vector<const GameState*> merged;
+    merged.reserve(added.size() + userGames.size());
+    std::merge(added.begin(), added.end(), userGames.begin(), userGames.end(), std::back_inserter(merged), byTime);
+    userGames.swap(merged);
+    if (!added.empty()) {
+        list->generation++;
     }
-    return GameState();
+}
+
+const std::deque<GameState>& GameHistory::getRecentGames() const {
+    return gameHistory;
+}
+
+// Session games may already have been written to the database, so only
+// those it doesn't hold yet are added to its count.
+std::size_t GameHistory::getGameCount() const {
+    if (database) {
+        std::size_t count = database->countGames();
+        GameState stored;
+        for (const auto& game : gameHistory) {
+            if (!database->loadGame(game.gameId, stored)) count++;
+        }
+        return count;
+    }
+    if (archive) {
+        const auto reading = archive->lockForReading();
+        return archive->size() + gameHistory.size();
+    }
+    return storedGameCount + gameHistory.size();
+}
+
+GameRange GameHistory::getUserGames(const std::string& userId) {
+    if (archive) {
+        indexArchive();
+    }
+    if ((database || archive || storedGameCount > 0) && fetchedUsers.insert(userId).second) {
+        fetchStoredGames(userId);
+    }
+    auto user = gamesByUser.find(userId);
+    if (user == gamesByUser.end()) {
+        return GameRange();
+    }
+    return GameRange(user->second, user->second->games.size());
+}
+
+const GameState* GameHistory::getGameById(const std::string& gameId) {
+    auto held = gamesById.find(gameId);
+    if (held != gamesById.end()) {
+        return held->second;
+    }
+    if (archive) {
+        indexArchive();
+    }
+    GameState game;
+    const bool found = database ? database->loadGame(gameId, game) : loadStoredGame(gameId, game);
+    if (!found) {
+        return nullptr;
+    }
+    loadedGames.push_back(std::move(game));
+    indexGame(loadedGames.back());
+    return &loadedGames.back();
+}
+
+bool GameHistory::loadStoredGame(const std::string& gameId, GameState& game) {
+    // Candidates share the hash, so they are adjacent and in record order.
+    const std::uint64_t hash = storedIdEntry(gameId, 0);
+    const auto first = std::lower_bound(storedIds.begin(), storedIds.end(), hash);
+    const auto last = std::upper_bound(first, storedIds.end(), hash | 0xFFFFFFFFu);
+    std::vector<std::size_t> records;
+    // A later record of the same game supersedes an earlier one.
+    for (auto candidate = last; candidate != first; --candidate) {
+        records.push_back(static_cast<std::uint32_t>(candidate[-1]));
+    }
+    if (records.empty()) {
+        return false;
+    }
+    if (archive) {
+        const auto reading = archive->lockForReading();
+        record_format::GameRecordView view;
+        for (const std::size_t record : records) {
+            if (archive->view(record, view) && view.gameId == gameId) {
+                record_format::materializeGame(view, game);
+                return true;
+            }
+        }
+        return false;
+    }
+    // Games in the eager window are compared by key without copying them.
+    std::uint64_t key;
+    const bool inEagerStore = eagerStore.findGameKey(gameId, key);
+    auto record = records.begin();
+    for (; record != records.end() && *record >= firstEager; ++record) {
+        if (inEagerStore && eagerStore.gameKey(*record - firstEager) == key) {
+            eagerStore.get(*record - firstEager, game);
+            return true;
+        }
+    }
+    if (record == records.end()) {
+        return false;
+    }
+    // A streamed log can't be read from the middle, but the stream stops
+    // at the last record that could be this game.
+    const std::size_t lastRecord = *record;
+    bool found = false;
+    std::size_t position = 0;
+    olderGames->forEachGame([&](const GameState& stored) {
+        if (stored.gameId == gameId) {
+            game = stored;
+            found = true;
+        }
+        return position++ < lastRecord;
+    });
+    return found;
 }
 
 // This replayGame function remains useful for other potential features, so we keep it.
 GameLogic GameHistory::replayGame(const std::string& gameId, int moveIndex) {
     GameLogic replayedGame;
-    GameState gameState = getGameById(gameId);
+    const GameState* game = getGameById(gameId);
 
-    if (gameState.gameId.empty()) {
+    if (!game) {
         return replayedGame;
     }
+    const GameState& gameState = *game;
 
-    replayedGame.resetBoard();
+    replayedGame.setBoardConfig(gameState.boardSize, gameState.winLength);
 
     int movesToReplay = (moveIndex == -1) ?
                        gameState.moveHistory.size() :
@@ -88,6 +419,11 @@ GameLogic GameHistory::replayGame(const std::string& gameId, int moveIndex) {
     return replayedGame;
 }
 
+ReplayCursor GameHistory::openReplay(const std::string& gameId) {
+    const GameState* game = getGameById(gameId);
+    return game ? ReplayCursor(*game) : ReplayCursor();
+}
+
 std::string GameHistory::generateGameId() {
     std::random_device rd;
     std::mt19937 gen(rd());
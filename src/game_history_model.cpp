@@ -0,0 +1,177 @@
+/*
+================================================================================
+File: src/game_history_model.cpp
+Purpose: Implements GameHistoryModel. Rows are pointers into GameHistory's
+         own games; the model never copies a game.
+================================================================================
+*/
+#include "game_history_model.h"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace {
+
+const char* resultText(GameResult result) {
+    switch (result) {
+    case GameResult::X_WINS: return "You Won!";
+    case GameResult::O_WINS: return "Opponent Won";
+    case GameResult::DRAW: return "It's a Draw";
+    default: return "In Progress";
+    }
+}
+
+// 'lowerNeedle' is already lower-case.
+bool containsIgnoringCase(std::string_view text, const std::string& lowerNeedle) {
+    return std::search(text.begin(), text.end(), lowerNeedle.begin(), lowerNeedle.end(), [](char a, char b) {
+               return std::tolower(static_cast<unsigned char>(a)) == b;
+           }) != text.end();
+}
+
+} // namespace
+
+GameHistoryModel::GameHistoryModel(QObject* parent) : QAbstractTableModel(parent) {}
+
+QString GameHistoryModel::resultLabel(GameResult result) {
+    return QString(resultText(result));
+}
+
+void GameHistoryModel::setGames(GameRange newGames) {
+    games = newGames;
+    sort(sortColumn, sortOrder);
+}
+
+void GameHistoryModel::setFilterText(const QString& text) {
+    std::string lower = text.toStdString();
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == filter) {
+        return;
+    }
+    filter = std::move(lower);
+    restart();
+}
+
+const GameState* GameHistoryModel::gameAt(const QModelIndex& index) const {
+    if (!index.isValid() || index.row() < 0 || static_cast<std::size_t>(index.row()) >= rows.size()) {
+        return nullptr;
+    }
+    return rows[index.row()];
+}
+
+int GameHistoryModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(rows.size());
+}
+
+int GameHistoryModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant GameHistoryModel::data(const QModelIndex& index, int role) const {
+    const GameState* game = gameAt(index);
+    if (!game) {
+        return QVariant();
+    }
+    if (role == GameIdRole) {
+        return QVariant(QString::fromStdString(game->gameId));
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (index.column()) {
+    case DateColumn: return QVariant(QString::fromStdString(game->timestamp));
+    case OpponentColumn: return QVariant(QString::fromStdString(game->player2Id));
+    case ResultColumn: return QVariant(resultLabel(game->result));
+    case MovesColumn: return QVariant(static_cast<int>(game->moveHistory.size()));
+    default: return QVariant();
+    }
+}
+
+QVariant GameHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case DateColumn: return QVariant(QString("Date"));
+    case OpponentColumn: return QVariant(QString("Opponent"));
+    case ResultColumn: return QVariant(QString("Result"));
+    case MovesColumn: return QVariant(QString("Moves"));
+    default: return QVariant();
+    }
+}
+
+bool GameHistoryModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && scanned < games.size();
+}
+
+void GameHistoryModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid()) {
+        return;
+    }
+    std::vector<const GameState*> batch = nextBatch();
+    if (batch.empty()) {
+        return;
+    }
+    const int first = static_cast<int>(rows.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(batch.size()) - 1);
+    rows.insert(rows.end(), batch.begin(), batch.end());
+    endInsertRows();
+}
+
+// Sorting by date only changes which end of the index is read from.
+// Other columns sort the games once; equal keys stay newest first.
+void GameHistoryModel::sort(int column, Qt::SortOrder order) {
+    sortColumn = column;
+    sortOrder = order;
+    sorted.clear();
+    if (column != DateColumn) {
+        sorted.reserve(games.size());
+        for (const GameState& game : games) {
+            sorted.push_back(&game);
+        }
+        auto key = [column](const GameState* a, const GameState* b) {
+            switch (column) {
+            case OpponentColumn: return a->player2Id < b->player2Id;
+            case ResultColumn: return a->result < b->result;
+            default: return a->moveHistory.size() < b->moveHistory.size();
+            }
+        };
+        if (order == Qt::AscendingOrder) {
+            std::stable_sort(sorted.begin(), sorted.end(), key);
+        } else {
+            std::stable_sort(sorted.begin(), sorted.end(),
+                             [&key](const GameState* a, const GameState* b) { return key(b, a); });
+        }
+    }
+    restart();
+}
+
+const GameState* GameHistoryModel::ordered(std::size_t n) const {
+    if (sortColumn != DateColumn) {
+        return sorted[n];
+    }
+    return sortOrder == Qt::DescendingOrder ? &games[n] : &games[games.size() - 1 - n];
+}
+
+bool GameHistoryModel::accepts(const GameState& game) const {
+    return filter.empty() || containsIgnoringCase(game.player2Id, filter) ||
+           containsIgnoringCase(resultText(game.result), filter);
+}
+
+std::vector<const GameState*> GameHistoryModel::nextBatch() {
+    std::vector<const GameState*> batch;
+    while (scanned < games.size() && batch.size() < static_cast<std::size_t>(kFetchBatch)) {
+        const GameState* game = ordered(scanned++);
+        if (accepts(*game)) {
+            batch.push_back(game);
+        }
+    }
+    return batch;
+}
+
+void GameHistoryModel::restart() {
+    beginResetModel();
+    scanned = 0;
+    rows = nextBatch();
+    endResetModel();
+}
@@ -1,93 +1,161 @@
 // game_logic.cpp
 #include "game_logic.h"
+#include "zobrist.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
 
-GameLogic::GameLogic() {
-    resetBoard();
+namespace {
+
+// The four line directions: horizontal, vertical and both diagonals.
+constexpr int kDirections[4][2] = {{0, 1}, {1, 0}, {1, 1}, {1, -1}};
+
+Player other(Player player) {
+    return (player == Player::X) ? Player::O : Player::X;
 }
 
-void GameLogic::resetBoard() {
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            board[i][j] = Player::NONE;
+std::shared_ptr<const LineTable> buildLineTable(int size, int length) {
+    auto table = std::make_shared<LineTable>();
+    table->boardSize = size;
+    table->winLength = length;
+    std::vector<std::vector<std::int16_t>> linesThroughCell(size * size);
+    for (const auto& dir : kDirections) {
+        for (int row = 0; row < size; ++row) {
+            for (int col = 0; col < size; ++col) {
+                const int endRow = row + (length - 1) * dir[0];
+                const int endCol = col + (length - 1) * dir[1];
+                if (endRow >= size || endCol < 0 || endCol >= size) continue;
+
+                const auto line = static_cast<std::int16_t>(table->lineCount());
+                const int step = dir[0] * size + dir[1];
+                table->lineStart.push_back(static_cast<std::int16_t>(GameLogic::cellIndex(row, col, size)));
+                table->lineStep.push_back(static_cast<std::int16_t>(step));
+                for (int i = 0; i < length; ++i) {
+                    linesThroughCell[GameLogic::cellIndex(row, col, size) + i * step].push_back(line);
+                }
+            }
         }
     }
+    table->cellLineBegin.push_back(0);
+    for (const auto& cellLines : linesThroughCell) {
+        table->cellLines.insert(table->cellLines.end(), cellLines.begin(), cellLines.end());
+        table->cellLineBegin.push_back(static_cast<std::int32_t>(table->cellLines.size()));
+    }
+    return table;
+}
+
+// Tables are immutable once built, so one per configuration is shared by
+// every game (and every copy the AI search threads make).
+std::shared_ptr<const LineTable> lineTableFor(int size, int length) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const LineTable>> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& table = cache[{size, length}];
+    if (!table) {
+        table = buildLineTable(size, length);
+    }
+    return table;
+}
+
+} // namespace
+
+GameLogic::GameLogic(int boardSize, int winLength) {
+    setBoardConfig(boardSize, winLength);
+}
+
+void GameLogic::setBoardConfig(int size, int length) {
+    boardSize = std::clamp(size, kMinBoardSize, kMaxBoardSize);
+    winLength = std::clamp(length, 3, boardSize);
+    lines = lineTableFor(boardSize, winLength);
+    // A game never has more moves than cells, so reserving once means
+    // makeMove/undoLastMove never reallocate the history afterwards.
+    moveHistory.reserve(getCellCount());
+    resetBoard();
+}
+
+void GameLogic::resetBoard() {
+    xMask.clear();
+    oMask.clear();
+    // Seeding the hash with the geometry keeps, e.g., "X in the corner" on
+    // 3x3 and 4x4 from sharing a key in a long-lived transposition table.
+    hashKey = zobrist::configKey(boardSize, winLength);
     currentPlayer = Player::X;
     moveHistory.clear();
+    xLineCounts.assign(lines->lineCount(), 0);
+    oLineCounts.assign(lines->lineCount(), 0);
+    filledCells = 0;
+    result = GameResult::IN_PROGRESS;
+    decidedAtMove = -1;
+    winningLine = -1;
 }
 
 bool GameLogic::makeMove(int row, int col) {
     if (!isValidMove(row, col)) {
         return false;
     }
-    board[row][col] = currentPlayer;
+    int cell = cellIndex(row, col, boardSize);
+    if (currentPlayer == Player::X) {
+        xMask.set(cell);
+    } else {
+        oMask.set(cell);
+    }
+    hashKey ^= zobrist::key(currentPlayer, cell);
     recordMove(row, col);
-    currentPlayer = (currentPlayer == Player::X) ? Player::O : Player::X;
+    filledCells++;
+
+    // Only the counters of lines through the new stone change: at most
+    // 4 * winLength of them. A line whose count reaches winLength is a win.
+    std::vector<std::uint8_t>& counts = (currentPlayer == Player::X) ? xLineCounts : oLineCounts;
+    const bool decided = result != GameResult::IN_PROGRESS;
+    for (int i = lines->cellLineBegin[cell]; i < lines->cellLineBegin[cell + 1]; ++i) {
+        const int line = lines->cellLines[i];
+        if (++counts[line] == winLength && !decided && winningLine < 0) {
+            winningLine = line;
+        }
+    }
+    if (!decided) {
+        if (winningLine >= 0) {
+            result = (currentPlayer == Player::X) ? GameResult::X_WINS : GameResult::O_WINS;
+        } else if (isBoardFull()) {
+            result = GameResult::DRAW;
+        }
+        if (result != GameResult::IN_PROGRESS) {
+            decidedAtMove = static_cast<int>(moveHistory.size());
+        }
+    }
+
+    currentPlayer = other(currentPlayer);
     return true;
 }
 
 bool GameLogic::isValidMove(int row, int col) const {
-    if (row < 0 || row >= 3 || col < 0 || col >= 3) {
+    if (row < 0 || row >= boardSize || col < 0 || col >= boardSize) {
         return false;
     }
-    return board[row][col] == Player::NONE;
+    int cell = cellIndex(row, col, boardSize);
+    return !xMask.test(cell) && !oMask.test(cell);
 }
 
 GameResult GameLogic::checkGameResult() const {
-    if (checkWin(Player::X)) return GameResult::X_WINS;
-    if (checkWin(Player::O)) return GameResult::O_WINS;
-    if (isBoardFull()) return GameResult::DRAW;
-    return GameResult::IN_PROGRESS;
-}
-
-bool GameLogic::checkWin(Player player) const {
-    // Check rows and columns
-    for (int i = 0; i < 3; i++) {
-        if ((board[i][0] == player && board[i][1] == player && board[i][2] == player) ||
-            (board[0][i] == player && board[1][i] == player && board[2][i] == player)) {
-            return true;
-        }
-    }
-    // Check diagonals
-    if ((board[0][0] == player && board[1][1] == player && board[2][2] == player) ||
-        (board[0][2] == player && board[1][1] == player && board[2][0] == player)) {
-        return true;
-    }
-    return false;
+    return result;
 }
 
-// NEWLY IMPLEMENTED: This function finds which 3 cells made the win.
+// Returns the cells of the line recorded when the game was won.
 std::vector<Move> GameLogic::findWinningCombination() const {
-    // Check rows
-    for (int i = 0; i < 3; i++) {
-        if (board[i][0] != Player::NONE && board[i][0] == board[i][1] && board[i][1] == board[i][2]) {
-            return {{i, 0}, {i, 1}, {i, 2}};
-        }
-    }
-    // Check columns
-    for (int i = 0; i < 3; i++) {
-        if (board[0][i] != Player::NONE && board[0][i] == board[1][i] && board[1][i] == board[2][i]) {
-            return {{0, i}, {1, i}, {2, i}};
-        }
-    }
-    // Check diagonals
-    if (board[0][0] != Player::NONE && board[0][0] == board[1][1] && board[1][1] == board[2][2]) {
-        return {{0, 0}, {1, 1}, {2, 2}};
+    if (winningLine < 0) {
+        return {}; // Return empty vector if no win
     }
-    if (board[0][2] != Player::NONE && board[0][2] == board[1][1] && board[1][1] == board[2][0]) {
-        return {{0, 2}, {1, 1}, {2, 0}};
+    std::vector<Move> cells;
+    for (int i = 0; i < winLength; ++i) {
+        const int cell = lines->lineStart[winningLine] + i * lines->lineStep[winningLine];
+        cells.emplace_back(cell / boardSize, cell % boardSize);
     }
-    return {}; // Return empty vector if no win
+    return cells;
 }
 
 bool GameLogic::isBoardFull() const {
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (board[i][j] == Player::NONE) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return filledCells == getCellCount();
 }
 
 Player GameLogic::getCurrentPlayer() const {
@@ -95,16 +163,43 @@ Player GameLogic::getCurrentPlayer() const {
 }
 
 Player GameLogic::getCell(int row, int col) const {
-    if (row >= 0 && row < 3 && col >= 0 && col < 3) {
-        return board[row][col];
+    if (row >= 0 && row < boardSize && col >= 0 && col < boardSize) {
+        int cell = cellIndex(row, col, boardSize);
+        if (xMask.test(cell)) return Player::X;
+        if (oMask.test(cell)) return Player::O;
     }
     return Player::NONE;
 }
 
-const std::array<std::array<Player, 3>, 3>& GameLogic::getBoard() const {
+std::vector<std::vector<Player>> GameLogic::getBoard() const {
+    std::vector<std::vector<Player>> board(boardSize, std::vector<Player>(boardSize));
+    for (int i = 0; i < boardSize; i++) {
+        for (int j = 0; j < boardSize; j++) {
+            board[i][j] = getCell(i, j);
+        }
+    }
     return board;
 }
 
+Bitboard GameLogic::getPlayerBits(Player player) const {
+    return static_cast<Bitboard>(getPlayerMask(player).word(0));
+}
+
+Bitboard GameLogic::getOccupiedBits() const {
+    return static_cast<Bitboard>(xMask.word(0) | oMask.word(0));
+}
+
+const BoardMask& GameLogic::getPlayerMask(Player player) const {
+    static const BoardMask kEmpty;
+    if (player == Player::X) return xMask;
+    if (player == Player::O) return oMask;
+    return kEmpty;
+}
+
+const std::vector<std::uint8_t>& GameLogic::getLineCounts(Player player) const {
+    return (player == Player::X) ? xLineCounts : oLineCounts;
+}
+
 void GameLogic::recordMove(int row, int col) {
     moveHistory.push_back(Move(row, col));
 }
@@ -114,23 +209,42 @@ const std::vector<Move>& GameLogic::getMoveHistory() const {
 }
 
 std::vector<Move> GameLogic::getAvailableMoves() const {
-    std::vector<Move> moves;
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (board[i][j] == Player::NONE) {
-                moves.push_back(Move(i, j));
-            }
+    MoveList list;
+    getAvailableMoves(list);
+    return std::vector<Move>(list.begin(), list.end());
+}
+
+void GameLogic::getAvailableMoves(MoveList& moves) const {
+    moves.clear();
+    const int cellCount = getCellCount();
+    for (int cell = 0; cell < cellCount; cell++) {
+        if (!xMask.test(cell) && !oMask.test(cell)) {
+            moves.push(Move(cell / boardSize, cell % boardSize));
         }
     }
-    return moves;
 }
 
 void GameLogic::undoLastMove() {
     if (!moveHistory.empty()) {
         Move lastMove = moveHistory.back();
-        board[lastMove.row][lastMove.col] = Player::NONE;
+        int cell = cellIndex(lastMove.row, lastMove.col, boardSize);
+        xMask.reset(cell);
+        oMask.reset(cell);
         moveHistory.pop_back();
+        filledCells--;
         // Switch player back
-        currentPlayer = (currentPlayer == Player::X) ? Player::O : Player::X;
+        currentPlayer = other(currentPlayer);
+        // The player to move again is the one who made the undone move.
+        hashKey ^= zobrist::key(currentPlayer, cell);
+        std::vector<std::uint8_t>& counts = (currentPlayer == Player::X) ? xLineCounts : oLineCounts;
+        for (int i = lines->cellLineBegin[cell]; i < lines->cellLineBegin[cell + 1]; ++i) {
+            counts[lines->cellLines[i]]--;
+        }
+        // Undoing the move that decided the game reopens it.
+        if (static_cast<int>(moveHistory.size()) < decidedAtMove) {
+            result = GameResult::IN_PROGRESS;
+            decidedAtMove = -1;
+            winningLine = -1;
+        }
     }
 }
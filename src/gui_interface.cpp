@@ -2,6 +2,7 @@
 #include "gui_interface.h"
 #include <QApplication>
 #include <QSettings>
+#include <QSignalBlocker>
 #include <QButtonGroup>
 #include <QFormLayout>
 #include <QGraphicsDropShadowEffect>
@@ -13,12 +14,29 @@
 #include <QFileInfo>
 #include <QDebug>
 #include <QHeaderView> 
-#include <QTableWidgetItem>
 #include <QPropertyAnimation>
 #include <QGraphicsOpacityEffect>
 #include <QParallelAnimationGroup> // For more complex animations
 #include <QPixmap>
 
+namespace {
+
+// The board variants offered in the "Board" combo box, in display order.
+struct BoardVariant {
+    const char* label;
+    int boardSize;
+    int winLength;
+};
+
+const BoardVariant kBoardVariants[] = {
+    {"3x3 (Classic)", 3, 3},
+    {"4x4 (4 in a row)", 4, 4},
+    {"5x5 (4 in a row)", 5, 4},
+    {"15x15 (Gomoku)", 15, 5},
+};
+
+} // namespace
+
 
 // =====================================================================================
 // --- Navigation and View Switching (SOLUTION AREA) ---
@@ -64,17 +82,20 @@ void GUIInterface::switchToSettingsView() {
 // =====================================================================================
 
 
-GUIInterface::GUIInterface(const std::string& dbPath, QWidget *parent)
+GUIInterface::GUIInterface(std::unique_ptr<StorageBackend> storageBackend, QWidget *parent)
     : QMainWindow(parent),
-      dbManager(dbPath),
+      storage(std::move(storageBackend)),
+      pendingAIMoveRequest(0),
+      pendingHintRequest(0),
       currentTheme(DARK),
       animationsEnabled(true),
       animationSpeed(300),
       isGameInProgress(false),
       isReplayMode(false),
       gameTimeSeconds(0),
-      replayMoveIndex(0),
       replayAutoMode(false) {
+    aiService = new AIService(this);
+    connect(aiService, &AIService::moveReady, this, &GUIInterface::onAIMoveReady);
     gameTimer = new QTimer(this);
     replayAutoTimer = new QTimer(this);
     connect(gameTimer, &QTimer::timeout, this, &GUIInterface::onGameTimerUpdate);
@@ -83,13 +104,16 @@ GUIInterface::GUIInterface(const std::string& dbPath, QWidget *parent)
     loadSettings();
     applyTheme(currentTheme);
     try {
-        auto loadedUsers = dbManager.loadUsers();
+        auto loadedUsers = storage->loadUsers();
         userAuth.setUsers(loadedUsers);
-        gameHistory.loadFromDatabase(dbManager);
+        gameHistory.loadFromDatabase(*storage);
     } catch (const std::exception& e) {
         qWarning() << "Could not load initial data from database: " << e.what();
     }
-    aiEngine.setDifficulty(difficultyCombo->currentIndex());
+    // Started only after the loads above, which use the backend directly.
+    persistence = std::make_unique<PersistenceWriter>(*storage);
+    aiService->setDifficulty(difficultyCombo->currentIndex());
+    aiService->setTimeBudget(aiSpeedSlider->value());
     switchToLoginView();
 }
 
@@ -268,19 +292,8 @@ void GUIInterface::setupGameBoard() {
     timerLabel->setObjectName("scoreLabel");
     boardFrame = new QFrame();
     boardFrame->setFixedSize(450, 450);
-    QGridLayout *boardLayout = new QGridLayout(boardFrame);
-    boardLayout->setSpacing(10);
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            boardButtons[i][j] = new QPushButton("");
-            boardButtons[i][j]->setProperty("class", "game-cell");
-            boardButtons[i][j]->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
-            connect(boardButtons[i][j], &QPushButton::clicked, this, &GUIInterface::onCellClicked);
-            boardButtons[i][j]->setProperty("row", i);
-            boardButtons[i][j]->setProperty("col", j);
-            boardLayout->addWidget(boardButtons[i][j], i, j);
-        }
-    }
+    boardLayout = new QGridLayout(boardFrame);
+    rebuildBoardButtons();
     setupReplayControls();
     centerLayout->addWidget(statusLabel);
     centerLayout->addWidget(timerLabel);
@@ -300,6 +313,57 @@ void GUIInterface::setupGameBoard() {
     mainStack->addWidget(gameWidget);
 }
 
+// Recreates the grid of cell buttons to match gameLogic's board size.
+void GUIInterface::rebuildBoardButtons() {
+    for (QPushButton* button : boardButtons) {
+        boardLayout->removeWidget(button);
+        delete button;
+    }
+    boardButtons.clear();
+
+    const int size = gameLogic.getBoardSize();
+    // The frame stays 450px wide, so big boards need tighter spacing and a
+    // smaller font (see the boardDensity rules in applyTheme).
+    const char* density = (size <= 3) ? "normal" : (size <= 5) ? "dense" : "compact";
+    boardLayout->setSpacing(size <= 3 ? 10 : size <= 5 ? 6 : 1);
+    boardButtons.reserve(size * size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            QPushButton* button = new QPushButton("");
+            button->setProperty("class", "game-cell");
+            button->setProperty("boardDensity", density);
+            button->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+            connect(button, &QPushButton::clicked, this, &GUIInterface::onCellClicked);
+            button->setProperty("row", i);
+            button->setProperty("col", j);
+            boardLayout->addWidget(button, i, j);
+            boardButtons.push_back(button);
+        }
+    }
+}
+
+QPushButton* GUIInterface::cellButton(int row, int col) const {
+    return boardButtons[row * gameLogic.getBoardSize() + col];
+}
+
+void GUIInterface::setBoardButtonsEnabled(bool enabled) {
+    for (QPushButton* button : boardButtons) button->setEnabled(enabled);
+}
+
+void GUIInterface::applyBoardConfig(int boardSize, int winLength) {
+    const int previousSize = gameLogic.getBoardSize();
+    gameLogic.setBoardConfig(boardSize, winLength);
+    if (gameLogic.getBoardSize() != previousSize) {
+        rebuildBoardButtons();
+    }
+}
+
+void GUIInterface::applySelectedBoardVariant() {
+    activeBoardVariant = boardVariantCombo->currentIndex();
+    const BoardVariant& variant = kBoardVariants[activeBoardVariant];
+    applyBoardConfig(variant.boardSize, variant.winLength);
+}
+
 void GUIInterface::setupScoreDisplay(QVBoxLayout* layout) {
     scoreFrame = new QFrame();
     scoreFrame->setProperty("class", "groupBox");
@@ -322,6 +386,16 @@ void GUIInterface::setupScoreDisplay(QVBoxLayout* layout) {
 }
 
 void GUIInterface::setupGameModeControls(QVBoxLayout* layout) {
+    boardVariantCombo = new QComboBox();
+    for (const BoardVariant& variant : kBoardVariants) {
+        boardVariantCombo->addItem(variant.label);
+    }
+    QFormLayout *variantLayout = new QFormLayout();
+    variantLayout->addRow("Board:", boardVariantCombo);
+    layout->addLayout(variantLayout);
+    // A different board means a different game, just like switching modes.
+    connect(boardVariantCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &GUIInterface::onNewGameButtonClicked);
+
     gameModeTab = new QTabWidget();
     
     aiModeWidget = new QWidget();
@@ -330,6 +404,15 @@ void GUIInterface::setupGameModeControls(QVBoxLayout* layout) {
     difficultyCombo->addItems({"Easy", "Medium", "Hard"});
     difficultyCombo->setCurrentIndex(1);
     aiLayout->addRow("Difficulty:", difficultyCombo);
+    // How long the AI may think per move, in milliseconds. Only the larger
+    // boards ever use the whole budget.
+    aiSpeedSlider = new QSlider(Qt::Horizontal);
+    aiSpeedSlider->setRange(100, 5000);
+    aiSpeedSlider->setSingleStep(100);
+    aiSpeedSlider->setPageStep(500);
+    aiSpeedSlider->setValue(static_cast<int>(AIEngine::kDefaultTimeBudget.count()));
+    aiSpeedSlider->setToolTip(QString("%1 ms per move").arg(aiSpeedSlider->value()));
+    aiLayout->addRow("Think Time:", aiSpeedSlider);
     gameModeTab->addTab(aiModeWidget, "vs AI");
     
     pvpModeWidget = new QWidget();
@@ -341,8 +424,9 @@ void GUIInterface::setupGameModeControls(QVBoxLayout* layout) {
     layout->addWidget(gameModeTab);
     connect(gameModeTab, &QTabWidget::currentChanged, this, &GUIInterface::onGameModeChanged);
     connect(difficultyCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index){
-        aiEngine.setDifficulty(index);
+        aiService->setDifficulty(index);
     });
+    connect(aiSpeedSlider, &QSlider::valueChanged, this, &GUIInterface::onAISpeedChanged);
 }
 
 void GUIInterface::setupGameControls(QVBoxLayout* layout) {
@@ -372,10 +456,18 @@ void GUIInterface::setupHistoryView() {
     QLabel* tableTitle = new QLabel("Game History");
     tableTitle->setObjectName("titleLabel");
     tableLayout->addWidget(tableTitle);
-    gameHistoryTable = new QTableWidget();
-    gameHistoryTable->setColumnCount(4);
-    gameHistoryTable->setHorizontalHeaderLabels({"Date", "Opponent", "Result", "Moves"});
+    historyFilterInput = new QLineEdit();
+    historyFilterInput->setPlaceholderText("Filter by opponent or result");
+    tableLayout->addWidget(historyFilterInput);
+    // The model reads straight from the history's per-user index and hands
+    // rows to the view as it scrolls.
+    gameHistoryModel = new GameHistoryModel(this);
+    gameHistoryTable = new QTableView();
+    gameHistoryTable->setModel(gameHistoryModel);
     gameHistoryTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    gameHistoryTable->horizontalHeader()->setSortIndicator(GameHistoryModel::DateColumn, Qt::DescendingOrder);
+    gameHistoryTable->setSortingEnabled(true);
+    gameHistoryTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
     gameHistoryTable->setSelectionBehavior(QAbstractItemView::SelectRows);
     gameHistoryTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
     tableLayout->addWidget(gameHistoryTable);
@@ -397,7 +489,8 @@ void GUIInterface::setupHistoryView() {
     btnLayout->addWidget(exportHistoryButton);
     historyLayout->addLayout(btnLayout);
     connect(exportHistoryButton, &QPushButton::clicked, this, &GUIInterface::exportGameHistory);
-    connect(gameHistoryTable, &QTableWidget::itemDoubleClicked, this, &GUIInterface::onGameHistoryItemClicked);
+    connect(gameHistoryTable, &QTableView::doubleClicked, this, &GUIInterface::onGameHistoryItemClicked);
+    connect(historyFilterInput, &QLineEdit::textChanged, gameHistoryModel, &GameHistoryModel::setFilterText);
     mainStack->addWidget(historyWidget);
 }
 
@@ -536,6 +629,8 @@ void GUIInterface::applyTheme(Theme theme) {
         QPushButton[class='logoutButton']:hover { background-color: #e74c3c; }
         QPushButton[class='game-cell'] { background-color: rgba(0, 0, 0, 0.2); font-size: 48px; font-weight: bold; }
         QPushButton[class='game-cell']:hover { background-color: rgba(0, 0, 0, 0.4); }
+        QPushButton[class='game-cell'][boardDensity='dense'] { font-size: 32px; padding: 4px; }
+        QPushButton[class='game-cell'][boardDensity='compact'] { font-size: 14px; padding: 0px; border-radius: 2px; }
         QLineEdit, QComboBox { padding: 8px; border: 1px solid #2c3e50; border-radius: 4px; background-color: #566573; color: white; }
         QLineEdit:focus { border-color: #3498db; }
         QFrame#loginFormContainer, QFrame[class='groupBox'], QGroupBox { background-color: rgba(0,0,0,0.2); border-radius: 15px; }
@@ -557,7 +652,7 @@ void GUIInterface::applyTheme(Theme theme) {
         color: white;
         }
         QFrame#welcomeFrame { background-color: transparent; }
-        QTableWidget { background-color: #566573; color: #ecf0f1; border: none; gridline-color: #34495e; selection-background-color: #3498db; }
+        QTableView { background-color: #566573; color: #ecf0f1; border: none; gridline-color: #34495e; selection-background-color: #3498db; }
         QHeaderView::section { background-color: #2c3e50; color: #ffffff; padding: 8px; border: none; font-weight: bold; }
         QLabel#mainTitleLabel { font-size: 36px; font-weight: bold; color: #ffffff; }
         QLabel#subTitleLabel { font-size: 20px; font-style: italic; color: #bdc3c7; }
@@ -571,13 +666,14 @@ void GUIInterface::applyTheme(Theme theme) {
 }
 
 void GUIInterface::updateButtonStyles() {
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
+    const int size = gameLogic.getBoardSize();
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
             Player cell = gameLogic.getCell(i, j);
             if (cell != Player::NONE) {
-                boardButtons[i][j]->setStyleSheet(QString("color: %1;").arg(getPlayerColor(cell).name()));
+                cellButton(i, j)->setStyleSheet(QString("color: %1;").arg(getPlayerColor(cell).name()));
             } else {
-                boardButtons[i][j]->setStyleSheet("");
+                cellButton(i, j)->setStyleSheet("");
             }
         }
     }
@@ -599,7 +695,8 @@ void GUIInterface::onLoginButtonClicked() {
 
 void GUIInterface::onRegisterButtonClicked() {
     if (userAuth.registerUser(usernameInput->text().toStdString(), passwordInput->text().toStdString())) {
-        dbManager.saveUsers(userAuth.getUsers());
+        // registerUser leaves the new account as the current user.
+        persistence->saveUser(*userAuth.getCurrentUser());
         showNotification("Registration Successful! Please log in.", "success");
         usernameInput->clear();
         passwordInput->clear();
@@ -624,7 +721,8 @@ void GUIInterface::onLogoutButtonClicked() {
 }
 
 void GUIInterface::onCellClicked() {
-    if (!isGameInProgress || isReplayMode) return;
+    // While the AI is thinking it is not the human's turn.
+    if (!isGameInProgress || isReplayMode || pendingAIMoveRequest != 0) return;
 
     QPushButton* button = qobject_cast<QPushButton*>(sender());
     if (!button) return;
@@ -643,7 +741,7 @@ void GUIInterface::onCellClicked() {
         } else {
             statusLabel->setText(getPlayerName(gameLogic.getCurrentPlayer()) + "'s Turn");
             if (gameModeTab->currentIndex() == 0 && gameLogic.getCurrentPlayer() == Player::O) {
-                QTimer::singleShot(animationSpeed + 50, this, &GUIInterface::makeAIMove);
+                makeAIMove();
             }
         }
     }
@@ -651,21 +749,25 @@ void GUIInterface::onCellClicked() {
 
 void GUIInterface::onNewGameButtonClicked() {
     if (isGameInProgress && QMessageBox::question(this, "New Game", "Abandon current game?", QMessageBox::Yes | QMessageBox::No) == QMessageBox::No) {
+        // Declining a board switch keeps the combo on the board still in play.
+        const QSignalBlocker blocker(boardVariantCombo);
+        boardVariantCombo->setCurrentIndex(activeBoardVariant);
         return;
     }
     
+    cancelAIRequests();
     isGameInProgress = true;
     isReplayMode = false;
     gameTimeSeconds = 0;
     
-    gameLogic.resetBoard();
+    applySelectedBoardVariant();
     updateBoard();
     statusLabel->setText(getPlayerName(gameLogic.getCurrentPlayer()) + "'s Turn");
     updateTimer();
     gameTimer->start(1000);
     
     setupReplayControls(false);
-    for(int r=0; r<3; ++r) for(int c=0; c<3; ++c) boardButtons[r][c]->setEnabled(true);
+    setBoardButtonsEnabled(true);
     undoButton->setEnabled(true);
     hintButton->setEnabled(true);
     
@@ -675,19 +777,19 @@ void GUIInterface::onNewGameButtonClicked() {
 void GUIInterface::onUndoMoveClicked() {
     if (!isGameInProgress || isReplayMode || gameLogic.getMoveHistory().empty()) return;
     
+    // A reply computed for the position being undone must never be played.
+    cancelAIRequests();
     gameLogic.undoLastMove();
     if (gameModeTab->currentIndex() == 0 && !gameLogic.getMoveHistory().empty()) {
         gameLogic.undoLastMove();
     }
     updateBoard();
+    statusLabel->setText(getPlayerName(gameLogic.getCurrentPlayer()) + "'s Turn");
 }
 
 void GUIInterface::onHintClicked() {
-    if (!isGameInProgress || isReplayMode) return;
-    Move hint = aiEngine.getBestMove(gameLogic);
-    if(hint.row != -1){
-        animateButton(boardButtons[hint.row][hint.col]);
-    }
+    if (!isGameInProgress || isReplayMode || pendingAIMoveRequest != 0) return;
+    pendingHintRequest = aiService->requestMove(gameLogic, AIService::HINT);
 }
 
 void GUIInterface::onGameModeChanged() {
@@ -702,29 +804,31 @@ void GUIInterface::onAnimationSpeedChanged(int value) {
     animationSpeed = value;
 }
 
-void GUIInterface::onGameHistoryItemClicked(QTableWidgetItem *item) {
-    if (!item) return;
+void GUIInterface::onAISpeedChanged(int value) {
+    aiSpeedSlider->setToolTip(QString("%1 ms per move").arg(value));
+    aiService->setTimeBudget(value);
+}
 
-    int row = item->row();
-    QVariant data = gameHistoryTable->item(row, 0)->data(Qt::UserRole);
+void GUIInterface::onGameHistoryItemClicked(const QModelIndex& index) {
+    QVariant data = gameHistoryModel->data(index, GameHistoryModel::GameIdRole);
     if (!data.isValid()) return;
 
     std::string gameId = data.toString().toStdString();
-    GameState game = gameHistory.getGameById(gameId);
+    const GameState* game = gameHistory.getGameById(gameId);
 
-    if (!game.gameId.empty()) {
+    if (game) {
         QString details;
-        details += "<b>Game ID:</b> " + QString::fromStdString(game.gameId) + "<br>";
-        details += "<b>Date:</b> " + QString::fromStdString(game.timestamp) + "<br>";
-        details += "<b>Opponent:</b> " + QString::fromStdString(game.player2Id) + "<br>";
-        details += "<b>Result:</b> " + formatGameResult(game.result) + "<br>";
+        details += "<b>Game ID:</b> " + QString::fromStdString(game->gameId) + "<br>";
+        details += "<b>Date:</b> " + QString::fromStdString(game->timestamp) + "<br>";
+        details += "<b>Opponent:</b> " + QString::fromStdString(game->player2Id) + "<br>";
+        details += "<b>Result:</b> " + formatGameResult(game->result) + "<br>";
         
         // This call now matches the GameState struct in game_logic.h
-        details += "<b>Duration:</b> " + QString::number(game.durationSeconds) + " seconds<br><br>";
+        details += "<b>Duration:</b> " + QString::number(game->durationSeconds) + " seconds<br><br>";
         details += "<b>Move List:</b><br>";
 
         int moveNumber = 1;
-        for (const auto& move : game.moveHistory) {
+        for (const auto& move : game->moveHistory) {
             QString player = (moveNumber % 2 != 0) ? "X" : "O";
             details += QString("%1. %2 to (%3, %4)<br>").arg(moveNumber).arg(player).arg(move.row).arg(move.col);
             moveNumber++;
@@ -732,11 +836,12 @@ void GUIInterface::onGameHistoryItemClicked(QTableWidgetItem *item) {
 
         gameDetailsText->setHtml(details);
         // Now, switch to the replay mode for the selected game.
-        displayGameForReplay(game);
+        displayGameForReplay(*game);
     }
 }
 
 void GUIInterface::handleGameOver(GameResult result) {
+    cancelAIRequests();
     isGameInProgress = false;
     gameTimer->stop();
     statusLabel->setText(formatGameResult(result));
@@ -745,7 +850,7 @@ void GUIInterface::handleGameOver(GameResult result) {
         highlightWinningCells(gameLogic.findWinningCombination());
     }
     animateGameOver(result);
-    for (int i = 0; i < 3; ++i) for (int j = 0; j < 3; ++j) boardButtons[i][j]->setEnabled(false);
+    setBoardButtonsEnabled(false);
     undoButton->setEnabled(false);
     hintButton->setEnabled(false);
 
@@ -755,13 +860,17 @@ void GUIInterface::handleGameOver(GameResult result) {
         // --- UPDATE: Pass game time and opponent type to the stats update function ---
         userAuth.updateUserStats(result, gameTimeSeconds, vsAI);
         
-        dbManager.saveUsers(userAuth.getUsers());
+        persistence->saveUser(*userAuth.getCurrentUser());
         std::string opponentId = vsAI ? "AI" : "Player2";
 
         gameHistory.saveGame(userAuth.getCurrentUser()->userId, opponentId, 
-                             vsAI, gameLogic.getMoveHistory(), result);
+                             vsAI, gameLogic.getMoveHistory(), result,
+                             gameLogic.getBoardSize(), gameLogic.getWinLength());
 
-        dbManager.saveGameHistory(gameHistory.getAllGames());
+        // Only the new game is written; the rest of the log is untouched.
+        persistence->appendGame(gameHistory.getRecentGames().back());
+        // Saving may have moved the rows the history model points at.
+        loadUserGames();
         
         // Refresh the UI with the new stats
         updateScoreDisplay(); 
@@ -769,11 +878,36 @@ void GUIInterface::handleGameOver(GameResult result) {
     }
 }
 
+// Starts the AI search in the background; the move is played in onAIMoveReady.
 void GUIInterface::makeAIMove() {
-    Move aiMove = aiEngine.getBestMove(gameLogic);
-    if(gameLogic.makeMove(aiMove.row, aiMove.col)) {
+    pendingHintRequest = 0; // The AI move request supersedes any hint search.
+    pendingAIMoveRequest = aiService->requestMove(gameLogic, AIService::AI_MOVE);
+    statusLabel->setText("AI is thinking...");
+}
+
+void GUIInterface::cancelAIRequests() {
+    aiService->cancel();
+    pendingAIMoveRequest = 0;
+    pendingHintRequest = 0;
+}
+
+void GUIInterface::onAIMoveReady(int requestId, int kind, int row, int col) {
+    if (kind == AIService::HINT) {
+        if (requestId != pendingHintRequest) return;
+        pendingHintRequest = 0;
+        if (row != -1) {
+            animateButton(cellButton(row, col));
+        }
+        return;
+    }
+
+    if (requestId != pendingAIMoveRequest) return;
+    pendingAIMoveRequest = 0;
+    if (!isGameInProgress || isReplayMode) return;
+
+    if (gameLogic.makeMove(row, col)) {
         updateBoard();
-        animateCellPlacement(aiMove.row, aiMove.col, Player::O);
+        animateCellPlacement(row, col, Player::O);
         
         GameResult result = gameLogic.checkGameResult();
         if (result != GameResult::IN_PROGRESS) {
@@ -790,7 +924,7 @@ void GUIInterface::animateCellPlacement(int row, int col, Player player) {
         return;
     }
 
-    QPushButton* button = boardButtons[row][col];
+    QPushButton* button = cellButton(row, col);
     if (!button) return; // Safety check
 
     // If an effect already exists, it will be managed by its parent (the button),
@@ -867,27 +1001,45 @@ void GUIInterface::onGameTimerUpdate() { if(isGameInProgress) gameTimeSeconds++;
 
 void GUIInterface::highlightWinningCells(const std::vector<Move>& cells) { 
     for(const auto& move : cells) {
-        boardButtons[move.row][move.col]->setStyleSheet("background-color: #f1c40f;");
+        cellButton(move.row, move.col)->setStyleSheet("background-color: #f1c40f;");
     }
 }
 
 void GUIInterface::resetBoardHighlights() { 
-    for(int r=0; r<3; ++r) for(int c=0; c<3; ++c) {
-        boardButtons[r][c]->setStyleSheet(""); 
+    for (QPushButton* button : boardButtons) {
+        button->setStyleSheet(""); 
     }
     updateButtonStyles(); 
 }
 
 void GUIInterface::updateBoard(bool isReplay) { 
+    if (isReplay) {
+        // Replays draw the cursor's snapshot, not gameLogic.
+        const int size = replayCursor.getBoardSize();
+        for (int i = 0; i < size; ++i) {
+            for (int j = 0; j < size; ++j) {
+                showReplayCell(i, j);
+            }
+        }
+        return;
+    }
     resetBoardHighlights(); 
-    for (int i = 0; i < 3; ++i) {
-        for (int j = 0; j < 3; ++j) {
-            boardButtons[i][j]->setText(getPlayerName(gameLogic.getCell(i, j)));
+    const int size = gameLogic.getBoardSize();
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            cellButton(i, j)->setText(getPlayerName(gameLogic.getCell(i, j)));
         }
     }
     updateButtonStyles(); 
 }
 
+void GUIInterface::showReplayCell(int row, int col) {
+    const Player cell = replayCursor.getCell(row, col);
+    QPushButton* button = cellButton(row, col);
+    button->setText(getPlayerName(cell));
+    button->setStyleSheet(cell != Player::NONE ? QString("color: %1;").arg(getPlayerColor(cell).name()) : QString());
+}
+
 void GUIInterface::updateScoreDisplay() { 
     if(userAuth.isLoggedIn()) { 
         const UserProfile* u = userAuth.getCurrentUser();
@@ -950,28 +1102,16 @@ void GUIInterface::updateGameStats() {
 }
 
 void GUIInterface::loadUserGames() {
-    gameHistoryTable->setRowCount(0);
-    if (!userAuth.isLoggedIn()) return;
-    
-    std::vector<GameState> userGames = gameHistory.getUserGames(userAuth.getCurrentUser()->userId);
-    
-    for (const auto& game : userGames) {
-        int row = gameHistoryTable->rowCount();
-        gameHistoryTable->insertRow(row);
-        
-        QTableWidgetItem* dateItem = new QTableWidgetItem(QString::fromStdString(game.timestamp));
-        dateItem->setData(Qt::UserRole, QVariant(QString::fromStdString(game.gameId)));
-        
-        gameHistoryTable->setItem(row, 0, dateItem);
-        gameHistoryTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(game.player2Id)));
-        gameHistoryTable->setItem(row, 2, new QTableWidgetItem(formatGameResult(game.result)));
-        gameHistoryTable->setItem(row, 3, new QTableWidgetItem(QString::number(game.moveHistory.size())));
+    if (!userAuth.isLoggedIn()) {
+        gameHistoryModel->setGames(GameRange());
+        return;
     }
+    gameHistoryModel->setGames(gameHistory.getUserGames(userAuth.getCurrentUser()->userId));
 }
 
 void GUIInterface::updateTimer() { timerLabel->setText(formatTime(gameTimeSeconds)); }
 QString GUIInterface::formatTime(int totalSeconds) { return QString("%1:%2").arg(totalSeconds / 60, 2, 10, QChar('0')).arg(totalSeconds % 60, 2, 10, QChar('0')); }
-QString GUIInterface::formatGameResult(GameResult result) { if (result == GameResult::X_WINS) return "You Won!"; if (result == GameResult::O_WINS) return "Opponent Won"; if (result == GameResult::DRAW) return "It's a Draw"; return "In Progress"; }
+QString GUIInterface::formatGameResult(GameResult result) { return GameHistoryModel::resultLabel(result); }
 QString GUIInterface::getPlayerName(Player player) { if (player == Player::X) return "X"; if (player == Player::O) return "O"; return ""; }
 QColor GUIInterface::getPlayerColor(Player player) { if (player == Player::X) return QColor("#3498DB"); if (player == Player::O) return QColor("#E74C3C"); return Qt::white; }
 void GUIInterface::showNotification(const QString& message, const QString& type) { QMessageBox msgBox(this); msgBox.setText(message); msgBox.setIcon(type == "error" ? QMessageBox::Critical : QMessageBox::Information); msgBox.setWindowTitle(type == "error" ? "Error" : "Notification"); msgBox.exec(); }
@@ -983,37 +1123,31 @@ void GUIInterface::onBackToGameClicked() { switchToGameView(); }
 
 // This slot is called when the "Next Move" (⏩) button is clicked.
 void GUIInterface::onReplayNextClicked() {
-    if (!isReplayMode || replayMoveIndex >= replayHistory.size()) {
+    if (!isReplayMode || !replayCursor.next()) {
         if(replayAutoTimer->isActive()) {
             replayAutoTimer->stop();
             replayAutoButton->setText("▶️");
         }
         return;
     }
-    const Move& nextMove = replayHistory[replayMoveIndex];
-    gameLogic.makeMove(nextMove.row, nextMove.col);
-    replayMoveIndex++;
-    updateBoard(true);
+    // Only the cell just played changes.
+    const Move& move = replayCursor.getMoves()[replayCursor.getPosition() - 1];
+    showReplayCell(move.row, move.col);
     updateReplayControls();
 }
 
 // This slot is called when the "Previous Move" (⏪) button is clicked.
 void GUIInterface::onReplayPrevClicked() {
-    if (!isReplayMode || replayMoveIndex <= 0) return;
-    replayMoveIndex--;
-    gameLogic.resetBoard();
-    for (int i = 0; i < replayMoveIndex; ++i) {
-        gameLogic.makeMove(replayHistory[i].row, replayHistory[i].col);
-    }
-    updateBoard(true);
+    if (!isReplayMode || !replayCursor.previous()) return;
+    const Move& move = replayCursor.getMoves()[replayCursor.getPosition()];
+    showReplayCell(move.row, move.col);
     updateReplayControls();
 }
 
 // This slot is called when the "Go to Start" (⏮️) button is clicked.
 void GUIInterface::onReplayStartClicked() {
     if (!isReplayMode) return;
-    replayMoveIndex = 0;
-    gameLogic.resetBoard();
+    replayCursor.seek(0);
     updateBoard(true);
     updateReplayControls();
 }
@@ -1025,7 +1159,7 @@ void GUIInterface::onReplayAutoPlay() {
         replayAutoTimer->stop();
         replayAutoButton->setText("▶️");
     } else {
-        if (replayMoveIndex >= replayHistory.size()) {
+        if (replayCursor.getPosition() >= replayCursor.getMoveCount()) {
             onReplayStartClicked();
         }
         replayAutoTimer->start(1200);
@@ -1036,10 +1170,11 @@ void GUIInterface::onReplayAutoPlay() {
 // This helper function updates the replay UI elements.
 void GUIInterface::updateReplayControls() {
     if (!isReplayMode) return;
-    replayPositionLabel->setText(QString("Move: %1 / %2").arg(replayMoveIndex).arg(replayHistory.size()));
-    replayPrevButton->setEnabled(replayMoveIndex > 0);
-    replayStartButton->setEnabled(replayMoveIndex > 0);
-    replayNextButton->setEnabled(replayMoveIndex < replayHistory.size());
+    const int position = replayCursor.getPosition();
+    replayPositionLabel->setText(QString("Move: %1 / %2").arg(position).arg(replayCursor.getMoveCount()));
+    replayPrevButton->setEnabled(position > 0);
+    replayStartButton->setEnabled(position > 0);
+    replayNextButton->setEnabled(position < replayCursor.getMoveCount());
 }
 
 // Applies a standard drop shadow effect to a widget for a sense of depth.
@@ -1082,10 +1217,11 @@ void GUIInterface::fadeInWidget(QWidget* widget) {
 }
 
 void GUIInterface::displayGameForReplay(const GameState& game) {
+    cancelAIRequests();
     isReplayMode = true;
-    gameLogic.resetBoard();
-    replayHistory = game.moveHistory;
-    replayMoveIndex = 0;
+    // Replays use the recorded game's board, whatever variant is selected.
+    applyBoardConfig(game.boardSize, game.winLength);
+    replayCursor = ReplayCursor(game);
     
     updateBoard(true); // Initial empty board state for replay
     updateReplayControls();
@@ -1097,6 +1233,7 @@ void GUIInterface::displayGameForReplay(const GameState& game) {
     timerLabel->setVisible(false);
     scoreFrame->setVisible(false);
     gameModeTab->setVisible(false);
+    boardVariantCombo->setEnabled(false);
     controlsFrame->setVisible(false); // Hide New Game, Undo, Hint buttons
     
     // Add a temporary button to exit the replay
@@ -1106,12 +1243,13 @@ void GUIInterface::displayGameForReplay(const GameState& game) {
 }
 
 void GUIInterface::switchToGameSetupView() {
+    cancelAIRequests();
     isGameInProgress = true; // Set the flag to allow starting a game
     isReplayMode = false;
     gameTimeSeconds = 0;
     
     // Reset the board logic and UI elements
-    gameLogic.resetBoard();
+    applySelectedBoardVariant();
     updateBoard(); // Redraws the empty board
     statusLabel->setText("Choose a mode and start playing!");
     updateTimer();
@@ -1122,13 +1260,12 @@ void GUIInterface::switchToGameSetupView() {
     timerLabel->setVisible(true);
     scoreFrame->setVisible(true);
     gameModeTab->setVisible(true);
+    boardVariantCombo->setEnabled(true);
     controlsFrame->setVisible(true);
     backToGameButton->setVisible(false);
     
     // Enable all buttons for the new game
-    for(int r=0; r<3; ++r) for(int c=0; c<3; ++c) {
-        boardButtons[r][c]->setEnabled(true);
-    }
+    setBoardButtonsEnabled(true);
     undoButton->setEnabled(true);
     hintButton->setEnabled(true);
     
@@ -0,0 +1,162 @@
+/*
+================================================================================
+File: src/in_memory_store.cpp
+Purpose: Implements InMemoryStore.
+================================================================================
+*/
+#include "in_memory_store.h"
+#include <algorithm>
+
+bool InMemoryStore::saveUsers(const std::unordered_map<std::string, UserProfile>& newUsers) {
+    std::lock_guard<std::mutex> lock(mutex);
+    users = newUsers;
+    return true;
+}
+
+std::unordered_map<std::string, UserProfile> InMemoryStore::loadUsers() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return users;
+}
+
+bool InMemoryStore::saveUser(const UserProfile& user) {
+    std::lock_guard<std::mutex> lock(mutex);
+    users[user.userId] = user;
+    return true;
+}
+
+bool InMemoryStore::loadUser(const std::string& userId, UserProfile& user) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto found = users.find(userId);
+    if (found == users.end()) {
+        return false;
+    }
+    user = found->second;
+    return true;
+}
+
+bool InMemoryStore::appendGames(const std::vector<GameState>& newGames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& game : newGames) {
+        putGame(game);
+    }
+    return true;
+}
+
+bool InMemoryStore::saveGameHistory(const std::vector<GameState>& newGames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    games.clear();
+    slotById.clear();
+    slotsByPlayer.clear();
+    for (const auto& game : newGames) {
+        putGame(game);
+    }
+    return true;
+}
+
+std::vector<GameState> InMemoryStore::loadGameHistory() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<GameState> history(games.size());
+    for (std::size_t slot = 0; slot < games.size(); ++slot) {
+        games.get(slot, history[slot]);
+    }
+    return history;
+}
+
+void InMemoryStore::forEachGame(const std::function<bool(const GameState&)>& visit) {
+    std::lock_guard<std::mutex> lock(mutex);
+    GameState game;
+    for (std::size_t slot = 0; slot < games.size(); ++slot) {
+        games.get(slot, game);
+        if (!visit(game)) return;
+    }
+}
+
+std::vector<GameState> InMemoryStore::loadUserGames(const std::string& userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<GameState> userGames;
+    std::uint32_t player;
+    if (!games.findPlayerKey(userId, player)) {
+        return userGames;
+    }
+    const auto found = slotsByPlayer.find(player);
+    if (found == slotsByPlayer.end()) {
+        return userGames;
+    }
+    userGames.resize(found->second.size());
+    for (std::size_t i = 0; i < userGames.size(); ++i) {
+        games.get(found->second[i], userGames[i]);
+    }
+    // Newest first, with ties in reverse save order (see storage_backend.h).
+    std::reverse(userGames.begin(), userGames.end());
+    std::stable_sort(userGames.begin(), userGames.end(),
+                     [](const GameState& a, const GameState& b) { return a.timestamp > b.timestamp; });
+    return userGames;
+}
+
+bool InMemoryStore::loadGame(const std::string& gameId, GameState& game) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t slot;
+    if (!findSlot(gameId, slot)) {
+        return false;
+    }
+    games.get(slot, game);
+    return true;
+}
+
+std::size_t InMemoryStore::countGames() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return games.size();
+}
+
+bool InMemoryStore::writeBatch(const std::unordered_map<std::string, UserProfile>& newUsers,
+                               const std::vector<GameState>& newGames) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& pair : newUsers) {
+        users[pair.first] = pair.second;
+    }
+    for (const auto& game : newGames) {
+        putGame(game);
+    }
+    return true;
+}
+
+void InMemoryStore::putGame(const GameState& game) {
+    std::size_t slot;
+    if (!findSlot(game.gameId, slot)) {
+        slot = games.append(game);
+        slotById.emplace(games.gameKey(slot), slot);
+        indexPlayers(slot);
+        return;
+    }
+    // Replaced in its slot, so the history keeps its order.
+    unindexPlayers(slot);
+    games.replace(slot, game);
+    indexPlayers(slot);
+}
+
+bool InMemoryStore::findSlot(const std::string& gameId, std::size_t& slot) const {
+    std::uint64_t key;
+    if (!games.findGameKey(gameId, key)) {
+        return false;
+    }
+    const auto found = slotById.find(key);
+    if (found == slotById.end()) {
+        return false;
+    }
+    slot = found->second;
+    return true;
+}
+
+void InMemoryStore::indexPlayers(std::size_t slot) {
+    slotsByPlayer[games.player1Key(slot)].push_back(slot);
+    if (games.player2Key(slot) != games.player1Key(slot)) {
+        slotsByPlayer[games.player2Key(slot)].push_back(slot);
+    }
+}
+
+void InMemoryStore::unindexPlayers(std::size_t slot) {
+    for (const std::uint32_t player : {games.player1Key(slot), games.player2Key(slot)}) {
+        auto& slots = slotsByPlayer[player];
+        slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+    }
+}
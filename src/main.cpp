@@ -3,9 +3,11 @@
 #include <iostream>
 #include <QStandardPaths>
 #include <QDir>
+#include <QCommandLineParser>
 #include "game_logic.h"
 #include "ai_engine.h"
 #include "gui_interface.h"
+#include "storage_backend.h"
 
 int main(int argc, char *argv[])
 {
@@ -23,8 +25,27 @@ int main(int argc, char *argv[])
     // Construct the full path to the database file.
     std::string dbFullPath = (writablePath + "/tictactoe_data.db").toStdString();
 
+    // Pick the storage backend: --storage text|binary|sqlite|memory.
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption storageOption("storage", "Storage backend: text, binary, sqlite or memory.", "backend", "sqlite");
+    parser.addOption(storageOption);
+    parser.process(app);
+
+    StorageKind storageKind = StorageKind::SQLite;
+    if (!parseStorageKind(parser.value(storageOption).toStdString(), storageKind)) {
+        std::cerr << "Unknown storage backend '" << parser.value(storageOption).toStdString()
+                  << "', using sqlite" << std::endl;
+    }
+    std::unique_ptr<StorageBackend> storage = openStorage(storageKind, dbFullPath);
+    if (!storage) {
+        // The flat files need nothing beyond the file system.
+        std::cerr << "Could not open " << storageKindName(storageKind) << " storage, using binary" << std::endl;
+        storage = openStorage(StorageKind::BinaryLog, dbFullPath);
+    }
+
     // Create and show the main GUI window.
-    GUIInterface gui(dbFullPath);
+    GUIInterface gui(std::move(storage));
     gui.show();
 
     // Start the Qt application event loop. This makes the window interactive
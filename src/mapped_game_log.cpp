@@ -0,0 +1,90 @@
+/*
+================================================================================
+File: src/mapped_game_log.cpp
+Purpose: Implements MappedGameLog on top of QFile::map, which gives the same
+         read-only mapping on every platform Qt supports.
+================================================================================
+*/
+#include "mapped_game_log.h"
+#include <QFile>
+
+MappedGameLog::MappedGameLog() = default;
+
+// Destroying the QFile unmaps the file.
+MappedGameLog::~MappedGameLog() = default;
+
+bool MappedGameLog::open(const std::string& path) {
+    this->path = path;
+    file = std::make_unique<QFile>(QString::fromStdString(path));
+    data = nullptr;
+    dataSize = 0;
+    recordOffsets.clear();
+    tornTail = false;
+    if (!file->open(QIODevice::ReadOnly) || file->size() < static_cast<qint64>(record_format::kHeaderSize)) {
+        file.reset();
+        return false;
+    }
+    const qint64 size = file->size();
+    const uchar* mapped = file->map(0, size);
+    if (!mapped || record_format::headerVersion(reinterpret_cast<const char*>(mapped), static_cast<std::size_t>(size),
+                                                record_format::kGamesMagic) != record_format::kVersion) {
+        file.reset();
+        return false;
+    }
+    data = reinterpret_cast<const char*>(mapped);
+    dataSize = static_cast<std::size_t>(size);
+
+    // Only the length prefixes are read here; payloads are left untouched
+    // until view() is called for them.
+    const char* p = data + record_format::kHeaderSize;
+    const char* end = data + dataSize;
+    while (p < end) {
+        const char* record = p;
+        std::string_view payload;
+        if (record_format::readFrame(p, end, payload, false) != record_format::FrameStatus::Ok) {
+            // A damaged length prefix: checksums find the next intact record.
+            p = record_format::findFrame(record + 1, end);
+            if (p == end) {
+                tornTail = true;
+                break;
+            }
+            continue;
+        }
+        recordOffsets.push_back(static_cast<std::uint64_t>(record - data));
+    }
+    return true;
+}
+
+void MappedGameLog::close() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    file.reset();
+    data = nullptr;
+    dataSize = 0;
+    recordOffsets.clear();
+    tornTail = false;
+}
+
+bool MappedGameLog::reopen() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    reopened++;
+    return open(path);
+}
+
+bool MappedGameLog::view(std::size_t index, record_format::GameRecordView& record) const {
+    if (index >= recordOffsets.size()) {
+        return false;
+    }
+    const char* p = data + recordOffsets[index];
+    std::string_view payload;
+    return record_format::readFrame(p, data + dataSize, payload) == record_format::FrameStatus::Ok &&
+           record_format::decodeGameView(payload, record);
+}
+
+bool MappedGameLog::materialize(std::size_t index, GameState& game) const {
+    record_format::GameRecordView record;
+    if (!view(index, record)) {
+        return false;
+    }
+    record_format::materializeGame(record, game);
+    return true;
+}
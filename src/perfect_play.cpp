@@ -0,0 +1,21 @@
+/*
+================================================================================
+File: src/perfect_play.cpp
+Purpose: Holds the generated perfect-play table. The initializer is written
+         into the build tree by tools/generate_perfect_play.cpp (see the
+         perfect_play_table target in CMakeLists.txt).
+================================================================================
+*/
+#include "perfect_play.h"
+
+namespace {
+
+const std::int8_t kBestCell[perfect_play::kPositionCount] = {
+#include "perfect_play_table.inc"
+};
+
+} // namespace
+
+int perfect_play::bestCell(Bitboard xBits, Bitboard oBits) {
+    return kBestCell[encode(xBits, oBits)];
+}
@@ -0,0 +1,89 @@
+/*
+================================================================================
+File: src/persistence_writer.cpp
+Purpose: Implements PersistenceWriter. Producers and the writer thread share
+         one mutex. The writer swaps the pending updates out under the lock
+         and does the file I/O without it, so a slow disk never blocks a
+         caller of saveUser or appendGame.
+================================================================================
+*/
+#include "persistence_writer.h"
+#include "storage_backend.h"
+#include <iostream>
+
+PersistenceWriter::PersistenceWriter(StorageBackend& storage, std::chrono::milliseconds window)
+    : db(storage), coalesceWindow(window), thread(&PersistenceWriter::writerLoop, this) {}
+
+PersistenceWriter::~PersistenceWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    // The writer drains the queue before it exits.
+    thread.join();
+}
+
+void PersistenceWriter::saveUser(const UserProfile& user) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingUsers[user.userId] = user;
+        queuedSeq++;
+    }
+    wakeUp.notify_one();
+}
+
+void PersistenceWriter::appendGame(const GameState& game) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingGames.push_back(game);
+        queuedSeq++;
+    }
+    wakeUp.notify_one();
+}
+
+void PersistenceWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    const std::uint64_t target = queuedSeq;
+    flushWaiters++;
+    wakeUp.notify_one();
+    written.wait(lock, [&] { return writtenSeq >= target; });
+    flushWaiters--;
+}
+
+PersistenceWriter::Stats PersistenceWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void PersistenceWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wakeUp.wait(lock, [this] { return stopping || queuedSeq != writtenSeq; });
+        if (queuedSeq == writtenSeq) {
+            return; // Stopping with nothing left to write.
+        }
+        // Let more updates pile up, unless someone is waiting on them.
+        wakeUp.wait_for(lock, coalesceWindow, [this] { return stopping || flushWaiters > 0; });
+
+        std::unordered_map<std::string, UserProfile> users;
+        std::vector<GameState> games;
+        users.swap(pendingUsers);
+        games.swap(pendingGames);
+        const std::uint64_t batchSeq = queuedSeq;
+        lock.unlock();
+
+        const std::uint64_t failed = db.writeBatch(users, games) ? 0 : users.size() + games.size();
+        if (failed > 0) {
+            std::cerr << "Persistence: " << failed << " update(s) could not be written" << std::endl;
+        }
+
+        lock.lock();
+        writtenSeq = batchSeq;
+        stats.batches++;
+        stats.userWrites += users.size();
+        stats.gameWrites += games.size();
+        stats.failedWrites += failed;
+        written.notify_all();
+    }
+}
@@ -0,0 +1,411 @@
+/*
+================================================================================
+File: src/record_format.cpp
+Purpose: Encoders and decoders for the binary game log and user store (see
+         include/record_format.h for the layout).
+================================================================================
+*/
+#include "record_format.h"
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr std::uint8_t kFlagAIOpponent = 1 << 0;
+constexpr std::uint8_t kFlagTextTimestamp = 1 << 1;
+
+// Boards with at most this many cells store two moves per byte.
+constexpr int kMaxNibbleCells = 16;
+constexpr std::size_t kUserStatsSize = 8 * 4 + 8;
+
+std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+void putString(std::string& out, const std::string& value) {
+    record_format::putVarint(out, value.size());
+    out += value;
+}
+
+bool getString(const char*& p, const char* end, std::string_view& value) {
+    std::uint64_t length;
+    if (!record_format::getVarint(p, end, length) || length > static_cast<std::uint64_t>(end - p)) {
+        return false;
+    }
+    value = std::string_view(p, static_cast<std::size_t>(length));
+    p += length;
+    return true;
+}
+
+bool getString(const char*& p, const char* end, std::string& value) {
+    std::string_view view;
+    if (!getString(p, end, view)) return false;
+    value.assign(view.data(), view.size());
+    return true;
+}
+
+void putFixed(std::string& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+std::uint64_t getFixed(const char* p, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return value;
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar, and back
+// (H. Hinnant's civil-date algorithms).
+std::int64_t daysFromCivil(std::int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+void civilFromDays(std::int64_t z, std::int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<std::int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+} // namespace
+
+std::string record_format::fileHeader(const char (&magic)[4]) {
+    std::string header(magic, 4);
+    header += static_cast<char>(kVersion);
+    header.append(kHeaderSize - 5, '\0');
+    return header;
+}
+
+int record_format::headerVersion(const char* data, std::size_t size, const char (&magic)[4]) {
+    if (size < kHeaderSize || std::memcmp(data, magic, 4) != 0) {
+        return 0;
+    }
+    return static_cast<std::uint8_t>(data[4]);
+}
+
+std::uint32_t record_format::crc32(const char* data, std::size_t size) {
+    static const std::array<std::uint32_t, 256> table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void record_format::putVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+bool record_format::getVarint(const char*& p, const char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const auto byte = static_cast<unsigned char>(*p++);
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool record_format::parseTimestamp(const std::string& text, std::int64_t& seconds) {
+    // "YYYY-MM-DD HH:MM:SS"
+    static const char kPattern[] = "dddd-dd-dd dd:dd:dd";
+    if (text.size() != sizeof(kPattern) - 1) return false;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const bool digit = text[i] >= '0' && text[i] <= '9';
+        if (kPattern[i] == 'd' ? !digit : text[i] != kPattern[i]) return false;
+    }
+    auto number = [&text](std::size_t pos, std::size_t length) {
+        int value = 0;
+        for (std::size_t i = pos; i < pos + length; ++i) value = value * 10 + (text[i] - '0');
+        return value;
+    };
+    const int month = number(5, 2);
+    const int day = number(8, 2);
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    seconds = daysFromCivil(number(0, 4), static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+              number(11, 2) * 3600 + number(14, 2) * 60 + number(17, 2);
+    // Rejects values that don't round-trip, such as 2023-02-30 or 25:00:00.
+    return formatTimestamp(seconds) == text;
+}
+
+std::string record_format::formatTimestamp(std::int64_t seconds) {
+    std::int64_t days = seconds / 86400;
+    std::int64_t rest = seconds % 86400;
+    if (rest < 0) {
+        rest += 86400;
+        days--;
+    }
+    std::int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+    // Room for any year a corrupt record could decode to, not just four
+    // digits: 20 for the year, 10 each for month and day, then the time.
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02u %02d:%02d:%02d",
+                  static_cast<long long>(year), month, day,
+                  static_cast<int>(rest / 3600), static_cast<int>(rest / 60 % 60), static_cast<int>(rest % 60));
+    return buffer;
+}
+
+void record_format::appendGameRecord(std::string& out, const GameState& game) {
+    std::string payload;
+    std::int64_t seconds = 0;
+    const bool textTimestamp = !parseTimestamp(game.timestamp, seconds);
+    payload += static_cast<char>((game.isAIOpponent ? kFlagAIOpponent : 0) |
+                                 (textTimestamp ? kFlagTextTimestamp : 0));
+    payload += static_cast<char>(game.result);
+    payload += static_cast<char>(game.boardSize);
+    payload += static_cast<char>(game.winLength);
+    putString(payload, game.gameId);
+    putString(payload, game.player1Id);
+    putString(payload, game.player2Id);
+    if (textTimestamp) {
+        putString(payload, game.timestamp);
+    } else {
+        putVarint(payload, zigzag(seconds));
+    }
+    putVarint(payload, zigzag(game.durationSeconds));
+
+    putVarint(payload, game.moveHistory.size());
+    packMoves(payload, game.moveHistory, game.boardSize);
+
+    appendFrame(out, payload);
+}
+
+void record_format::packMoves(std::string& out, const std::vector<Move>& moves, int boardSize) {
+    const bool nibbles = boardSize * boardSize <= kMaxNibbleCells;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const int cell = GameLogic::cellIndex(moves[i].row, moves[i].col, boardSize);
+        if (!nibbles) {
+            out += static_cast<char>(cell);
+        } else if (i % 2 == 0) {
+            out += static_cast<char>(cell);
+        } else {
+            out.back() = static_cast<char>(out.back() | (cell << 4));
+        }
+    }
+}
+
+bool record_format::unpackMoves(std::string_view packed, int count, int boardSize, std::vector<Move>& moves) {
+    if (boardSize <= 0 || count < 0 || count > boardSize * boardSize) {
+        return false;
+    }
+    GameRecordView view;
+    view.boardSize = boardSize;
+    view.moveCount = count;
+    view.packedMoves = packed;
+    const bool nibbles = boardSize * boardSize <= kMaxNibbleCells;
+    if (packed.size() != (nibbles ? static_cast<std::size_t>(count + 1) / 2 : static_cast<std::size_t>(count))) {
+        return false;
+    }
+    moves.clear();
+    moves.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        moves.push_back(view.move(i));
+        if (moves.back().row >= boardSize) return false;
+    }
+    return true;
+}
+
+void record_format::appendFrame(std::string& out, std::string_view payload) {
+    putVarint(out, payload.size());
+    out.append(payload.data(), payload.size());
+    putFixed(out, crc32(payload.data(), payload.size()), 4);
+}
+
+record_format::FrameStatus record_format::readGameRecord(const char*& p, const char* end, GameState& game) {
+    std::string_view payload;
+    const FrameStatus status = readFrame(p, end, payload);
+    if (status != FrameStatus::Ok) {
+        return status;
+    }
+    GameRecordView view;
+    if (!decodeGameView(payload, view)) {
+        return FrameStatus::Corrupt;
+    }
+    materializeGame(view, game);
+    return FrameStatus::Ok;
+}
+
+record_format::FrameStatus record_format::readFrame(const char*& p, const char* end, std::string_view& payload,
+                                                    bool verifyChecksum) {
+    const char* cursor = p;
+    std::uint64_t length;
+    const bool lengthRead = getVarint(cursor, end, length);
+    if (!lengthRead && cursor == end) {
+        return FrameStatus::Truncated;
+    }
+    // An unterminated or impossibly large length is damage, not a record
+    // whose end has yet to be read.
+    if (!lengthRead || length > kMaxFrameBytes) {
+        p = cursor;
+        return FrameStatus::Corrupt;
+    }
+    if (length + 4 > static_cast<std::uint64_t>(end - cursor)) {
+        return FrameStatus::Truncated;
+    }
+    payload = std::string_view(cursor, static_cast<std::size_t>(length));
+    p = cursor + length + 4;
+    if (verifyChecksum &&
+        static_cast<std::uint32_t>(getFixed(cursor + length, 4)) != crc32(payload.data(), payload.size())) {
+        return FrameStatus::Corrupt;
+    }
+    return FrameStatus::Ok;
+}
+
+const char* record_format::findFrame(const char* p, const char* end) {
+    for (; p < end; ++p) {
+        const char* next = p;
+        std::string_view payload;
+        if (readFrame(next, end, payload) == FrameStatus::Ok) {
+            return p;
+        }
+    }
+    return end;
+}
+
+bool record_format::decodeGameView(std::string_view payload, GameRecordView& view) {
+    const char* p = payload.data();
+    const char* end = p + payload.size();
+    if (end - p < 4) return false;
+    const auto flags = static_cast<std::uint8_t>(p[0]);
+    const auto result = static_cast<std::uint8_t>(p[1]);
+    view.boardSize = static_cast<std::uint8_t>(p[2]);
+    view.winLength = static_cast<std::uint8_t>(p[3]);
+    p += 4;
+    if (result > static_cast<int>(GameResult::DRAW) || view.boardSize == 0 || view.boardSize > 16) {
+        return false;
+    }
+    view.isAIOpponent = (flags & kFlagAIOpponent) != 0;
+    view.result = static_cast<GameResult>(result);
+
+    if (!getString(p, end, view.gameId) || !getString(p, end, view.player1Id) ||
+        !getString(p, end, view.player2Id)) {
+        return false;
+    }
+    std::uint64_t value;
+    view.textTimestamp = (flags & kFlagTextTimestamp) != 0;
+    if (view.textTimestamp) {
+        if (!getString(p, end, view.timestampText)) return false;
+    } else {
+        if (!getVarint(p, end, value)) return false;
+        view.timestampSeconds = unzigzag(value);
+    }
+    if (!getVarint(p, end, value)) return false;
+    view.durationSeconds = static_cast<int>(unzigzag(value));
+
+    std::uint64_t moveCount;
+    const int cellCount = view.boardSize * view.boardSize;
+    if (!getVarint(p, end, moveCount) || moveCount > static_cast<std::uint64_t>(cellCount)) {
+        return false;
+    }
+    const bool nibbles = cellCount <= kMaxNibbleCells;
+    const std::size_t moveBytes = nibbles ? (moveCount + 1) / 2 : moveCount;
+    if (static_cast<std::size_t>(end - p) != moveBytes) return false;
+    view.moveCount = static_cast<int>(moveCount);
+    view.packedMoves = std::string_view(p, moveBytes);
+    for (int i = 0; i < view.moveCount; ++i) {
+        const Move move = view.move(i);
+        if (move.row >= view.boardSize) return false;
+    }
+    return true;
+}
+
+std::string record_format::GameRecordView::timestamp() const {
+    return textTimestamp ? std::string(timestampText) : formatTimestamp(timestampSeconds);
+}
+
+Move record_format::GameRecordView::move(int index) const {
+    const bool nibbles = boardSize * boardSize <= kMaxNibbleCells;
+    const auto byte = static_cast<unsigned char>(packedMoves[nibbles ? index / 2 : index]);
+    const int cell = nibbles ? ((index % 2 == 0) ? byte & 0x0F : byte >> 4) : byte;
+    return Move(cell / boardSize, cell % boardSize);
+}
+
+void record_format::materializeGame(const GameRecordView& view, GameState& game) {
+    game.gameId.assign(view.gameId.data(), view.gameId.size());
+    game.player1Id.assign(view.player1Id.data(), view.player1Id.size());
+    game.player2Id.assign(view.player2Id.data(), view.player2Id.size());
+    game.isAIOpponent = view.isAIOpponent;
+    game.result = view.result;
+    game.boardSize = view.boardSize;
+    game.winLength = view.winLength;
+    game.timestamp = view.timestamp();
+    game.durationSeconds = view.durationSeconds;
+    game.moveHistory.clear();
+    game.moveHistory.reserve(view.moveCount);
+    for (int i = 0; i < view.moveCount; ++i) {
+        game.moveHistory.push_back(view.move(i));
+    }
+}
+
+std::string record_format::encodeUser(const UserProfile& user) {
+    std::string out;
+    out += static_cast<char>(kUserLive);
+    putString(out, user.userId);
+    putString(out, user.username);
+    putString(out, user.passwordHash);
+    for (int value : {user.gamesPlayed, user.gamesWon, user.gamesLost, user.gamesTied,
+                      user.currentWinStreak, user.longestWinStreak, user.aiGamesPlayed,
+                      user.pvpGamesPlayed}) {
+        putFixed(out, static_cast<std::uint32_t>(value), 4);
+    }
+    putFixed(out, static_cast<std::uint64_t>(user.totalGameTimeSeconds), 8);
+    return out;
+}
+
+bool record_format::decodeUser(const char*& p, const char* end, UserProfile& user, bool& live) {
+    const char* cursor = p;
+    if (cursor == end) return false;
+    const auto state = static_cast<std::uint8_t>(*cursor++);
+    if (state != kUserLive && state != kUserDead) return false;
+    if (!getString(cursor, end, user.userId) || !getString(cursor, end, user.username) ||
+        !getString(cursor, end, user.passwordHash) ||
+        static_cast<std::size_t>(end - cursor) < kUserStatsSize) {
+        return false;
+    }
+    int* counters[] = {&user.gamesPlayed, &user.gamesWon, &user.gamesLost, &user.gamesTied,
+                       &user.currentWinStreak, &user.longestWinStreak, &user.aiGamesPlayed,
+                       &user.pvpGamesPlayed};
+    for (int* counter : counters) {
+        *counter = static_cast<std::int32_t>(getFixed(cursor, 4));
+        cursor += 4;
+    }
+    user.totalGameTimeSeconds = static_cast<std::int64_t>(getFixed(cursor, 8));
+    p = cursor + 8;
+    live = state == kUserLive;
+    return true;
+}
@@ -0,0 +1,54 @@
+/*
+================================================================================
+File: src/replay_cursor.cpp
+Purpose: Implements ReplayCursor by playing the game through GameLogic once
+         and keeping its bitboards after every move.
+================================================================================
+*/
+#include "replay_cursor.h"
+#include <algorithm>
+
+ReplayCursor::ReplayCursor() : ReplayCursor(GameState()) {}
+
+ReplayCursor::ReplayCursor(const GameState& game) : position(0) {
+    GameLogic logic(game.boardSize, game.winLength);
+    boardSize = logic.getBoardSize();
+    winLength = logic.getWinLength();
+    snapshots.reserve(game.moveHistory.size() + 1);
+    snapshots.push_back({logic.getPlayerMask(Player::X), logic.getPlayerMask(Player::O), logic.checkGameResult()});
+    for (const Move& move : game.moveHistory) {
+        if (!logic.makeMove(move.row, move.col)) {
+            break;
+        }
+        moves.push_back(move);
+        snapshots.push_back({logic.getPlayerMask(Player::X), logic.getPlayerMask(Player::O), logic.checkGameResult()});
+    }
+}
+
+bool ReplayCursor::next() {
+    return seek(position + 1);
+}
+
+bool ReplayCursor::previous() {
+    return seek(position - 1);
+}
+
+bool ReplayCursor::seek(int ply) {
+    ply = std::clamp(ply, 0, getMoveCount());
+    if (ply == position) {
+        return false;
+    }
+    position = ply;
+    return true;
+}
+
+Player ReplayCursor::getCell(int row, int col) const {
+    if (row < 0 || row >= boardSize || col < 0 || col >= boardSize) {
+        return Player::NONE;
+    }
+    const int cell = GameLogic::cellIndex(row, col, boardSize);
+    const Snapshot& snapshot = snapshots[position];
+    if (snapshot.x.test(cell)) return Player::X;
+    if (snapshot.o.test(cell)) return Player::O;
+    return Player::NONE;
+}
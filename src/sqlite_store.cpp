@@ -0,0 +1,428 @@
+/*
+================================================================================
+File: src/sqlite_store.cpp
+Purpose: Implements SqliteStore on Qt's QSQLITE driver. The schema is created
+         on open; all statements are prepared with positional parameters.
+================================================================================
+*/
+#include "sqlite_store.h"
+#include "record_format.h"
+#include <QByteArray>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iostream>
+
+namespace {
+
+// games.seq keeps the order games were first saved in; re-saving a game
+// updates its row in place.
+const char* const kSchema[] = {
+    "CREATE TABLE IF NOT EXISTS users ("
+    " user_id TEXT PRIMARY KEY, username TEXT NOT NULL, password_hash TEXT NOT NULL,"
+    " games_played INTEGER NOT NULL, games_won INTEGER NOT NULL, games_lost INTEGER NOT NULL,"
+    " games_tied INTEGER NOT NULL, total_game_time INTEGER NOT NULL,"
+    " current_win_streak INTEGER NOT NULL, longest_win_streak INTEGER NOT NULL,"
+    " ai_games_played INTEGER NOT NULL, pvp_games_played INTEGER NOT NULL)",
+    "CREATE TABLE IF NOT EXISTS games ("
+    " seq INTEGER PRIMARY KEY, game_id TEXT NOT NULL, player1_id TEXT NOT NULL,"
+    " player2_id TEXT NOT NULL, is_ai INTEGER NOT NULL, result INTEGER NOT NULL,"
+    " timestamp TEXT NOT NULL, duration INTEGER NOT NULL, board_size INTEGER NOT NULL,"
+    " win_length INTEGER NOT NULL, move_count INTEGER NOT NULL, moves BLOB NOT NULL)",
+    "CREATE UNIQUE INDEX IF NOT EXISTS games_by_id ON games (game_id)",
+    "CREATE INDEX IF NOT EXISTS games_by_player1 ON games (player1_id, timestamp)",
+    "CREATE INDEX IF NOT EXISTS games_by_player2 ON games (player2_id, timestamp)",
+    "CREATE INDEX IF NOT EXISTS games_by_timestamp ON games (timestamp)",
+};
+
+const char* const kUserColumns =
+    "user_id, username, password_hash, games_played, games_won, games_lost, games_tied,"
+    " total_game_time, current_win_streak, longest_win_streak, ai_games_played, pvp_games_played";
+
+const char* const kGameColumns =
+    "game_id, player1_id, player2_id, is_ai, result, timestamp, duration, board_size,"
+    " win_length, move_count, moves";
+
+const char* const kUpsertGame =
+    "INSERT INTO games (game_id, player1_id, player2_id, is_ai, result, timestamp, duration,"
+    " board_size, win_length, move_count, moves) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+    " ON CONFLICT (game_id) DO UPDATE SET player1_id = excluded.player1_id,"
+    " player2_id = excluded.player2_id, is_ai = excluded.is_ai, result = excluded.result,"
+    " timestamp = excluded.timestamp, duration = excluded.duration,"
+    " board_size = excluded.board_size, win_length = excluded.win_length,"
+    " move_count = excluded.move_count, moves = excluded.moves";
+
+const char* const kSynchronousFull = "PRAGMA synchronous = FULL";
+const char* const kSynchronousOff = "PRAGMA synchronous = OFF";
+
+std::atomic<int> nextStoreId{0};
+std::atomic<std::uint64_t> nextThreadSerial{0};
+
+QString text(const std::string& value) {
+    return QString::fromStdString(value);
+}
+
+void closeConnection(const std::string& name) {
+    {
+        QSqlDatabase db = QSqlDatabase::database(text(name), false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(text(name));
+}
+
+// The connections the current thread opened, which Qt only lets that
+// thread close; they are closed when it exits. Connection names use this
+// serial rather than the thread id, which a later thread can be given.
+struct ThreadConnections {
+    const std::uint64_t serial = nextThreadSerial++;
+    std::vector<std::string> names;
+
+    ~ThreadConnections() {
+        for (const auto& name : names) {
+            closeConnection(name);
+        }
+    }
+};
+
+thread_local ThreadConnections threadConnections;
+
+void logError(const char* what, const QSqlError& error) {
+    std::cerr << "SQLite: " << what << ": " << error.text().toStdString() << std::endl;
+}
+
+void bindAll(QSqlQuery& query, std::initializer_list<QVariant> values) {
+    int position = 0;
+    for (const QVariant& value : values) {
+        query.bindValue(position++, value);
+    }
+}
+
+bool execPrepared(QSqlQuery& query, const char* what) {
+    if (!query.exec()) {
+        logError(what, query.lastError());
+        return false;
+    }
+    return true;
+}
+
+bool prepare(QSqlQuery& query, const std::string& sql) {
+    if (!query.prepare(text(sql))) {
+        logError("prepare", query.lastError());
+        return false;
+    }
+    return true;
+}
+
+bool prepareUpsertUser(QSqlQuery& query) {
+    return prepare(query, std::string("INSERT OR REPLACE INTO users (") + kUserColumns +
+                              ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+}
+
+bool execUpsertUser(QSqlQuery& query, const UserProfile& user) {
+    bindAll(query, {text(user.userId), text(user.username), text(user.passwordHash), user.gamesPlayed,
+                    user.gamesWon, user.gamesLost, user.gamesTied,
+                    static_cast<qlonglong>(user.totalGameTimeSeconds), user.currentWinStreak,
+                    user.longestWinStreak, user.aiGamesPlayed, user.pvpGamesPlayed});
+    return execPrepared(query, "save user");
+}
+
+bool execUpsertGame(QSqlQuery& query, const GameState& game) {
+    std::string moves;
+    record_format::packMoves(moves, game.moveHistory, game.boardSize);
+    bindAll(query, {text(game.gameId), text(game.player1Id), text(game.player2Id), game.isAIOpponent ? 1 : 0,
+                    static_cast<int>(game.result), text(game.timestamp), game.durationSeconds, game.boardSize,
+                    game.winLength, static_cast<int>(game.moveHistory.size()),
+                    QByteArray(moves.data(), static_cast<int>(moves.size()))});
+    return execPrepared(query, "save game");
+}
+
+// Reads a row selected with kUserColumns.
+void readUser(const QSqlQuery& query, UserProfile& user) {
+    user.userId = query.value(0).toString().toStdString();
+    user.username = query.value(1).toString().toStdString();
+    user.passwordHash = query.value(2).toString().toStdString();
+    user.gamesPlayed = query.value(3).toInt();
+    user.gamesWon = query.value(4).toInt();
+    user.gamesLost = query.value(5).toInt();
+    user.gamesTied = query.value(6).toInt();
+    user.totalGameTimeSeconds = query.value(7).toLongLong();
+    user.currentWinStreak = query.value(8).toInt();
+    user.longestWinStreak = query.value(9).toInt();
+    user.aiGamesPlayed = query.value(10).toInt();
+    user.pvpGamesPlayed = query.value(11).toInt();
+}
+
+// Reads a row selected with kGameColumns; false if the row is malformed.
+bool readGame(const QSqlQuery& query, GameState& game) {
+    const int result = query.value(4).toInt();
+    if (result < 0 || result > static_cast<int>(GameResult::DRAW)) {
+        return false;
+    }
+    game.gameId = query.value(0).toString().toStdString();
+    game.player1Id = query.value(1).toString().toStdString();
+    game.player2Id = query.value(2).toString().toStdString();
+    game.isAIOpponent = query.value(3).toInt() != 0;
+    game.result = static_cast<GameResult>(result);
+    game.timestamp = query.value(5).toString().toStdString();
+    game.durationSeconds = query.value(6).toInt();
+    game.boardSize = query.value(7).toInt();
+    game.winLength = query.value(8).toInt();
+    const QByteArray moves = query.value(10).toByteArray();
+    return record_format::unpackMoves(std::string_view(moves.constData(), static_cast<std::size_t>(moves.size())),
+                                      query.value(9).toInt(), game.boardSize, game.moveHistory);
+}
+
+std::vector<GameState> readGames(QSqlQuery& query) {
+    std::vector<GameState> games;
+    while (query.next()) {
+        GameState game;
+        if (readGame(query, game)) {
+            games.push_back(std::move(game));
+        }
+    }
+    return games;
+}
+
+// Runs 'body' in a transaction, committing only if it succeeds.
+template <typename Body>
+bool inTransaction(QSqlDatabase db, Body&& body) {
+    if (!db.transaction()) {
+        logError("begin", db.lastError());
+        return false;
+    }
+    if (!body()) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        logError("commit", db.lastError());
+        db.rollback();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+SqliteStore::SqliteStore(std::string dbPath, bool sync)
+    : path(std::move(dbPath)), syncWrites(sync),
+      connectionPrefix("tictactoe-sqlite-" + std::to_string(nextStoreId++)) {}
+
+// Only the calling thread's connection can be closed here. Other threads
+// close theirs when they exit.
+SqliteStore::~SqliteStore() {
+    const std::string name = connectionPrefix + '-' + std::to_string(threadConnections.serial);
+    auto& names = threadConnections.names;
+    auto own = std::find(names.begin(), names.end(), name);
+    if (own != names.end()) {
+        names.erase(own);
+        closeConnection(name);
+    }
+}
+
+QSqlDatabase SqliteStore::connection() {
+    const std::string name = connectionPrefix + '-' + std::to_string(threadConnections.serial);
+    const QString connectionName = text(name);
+    if (QSqlDatabase::contains(connectionName)) {
+        return QSqlDatabase::database(connectionName);
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    threadConnections.names.push_back(name);
+    db.setDatabaseName(text(path));
+    if (!db.open()) {
+        logError("open", db.lastError());
+        return db;
+    }
+    QSqlQuery pragma(db);
+    pragma.exec("PRAGMA journal_mode = WAL");
+    pragma.exec(syncWrites ? kSynchronousFull : kSynchronousOff);
+    // Wait for another connection's write to finish instead of failing.
+    pragma.exec("PRAGMA busy_timeout = 5000");
+    return db;
+}
+
+bool SqliteStore::open() {
+    QSqlDatabase db = connection();
+    if (!db.isOpen()) {
+        return false;
+    }
+    QSqlQuery query(db);
+    for (const char* statement : kSchema) {
+        if (!query.exec(statement)) {
+            logError("create schema", query.lastError());
+            return false;
+        }
+    }
+    return true;
+}
+
+void SqliteStore::setSyncWrites(bool sync) {
+    syncWrites = sync;
+    QSqlQuery pragma(connection());
+    pragma.exec(sync ? kSynchronousFull : kSynchronousOff);
+}
+
+bool SqliteStore::isEmpty() {
+    QSqlQuery query(connection());
+    return query.exec("SELECT EXISTS (SELECT 1 FROM users) OR EXISTS (SELECT 1 FROM games)") && query.next() &&
+           query.value(0).toInt() == 0;
+}
+
+bool SqliteStore::saveUsers(const std::unordered_map<std::string, UserProfile>& users) {
+    QSqlDatabase db = connection();
+    return inTransaction(db, [&] {
+        QSqlQuery query(db);
+        if (!query.exec("DELETE FROM users") || !prepareUpsertUser(query)) {
+            return false;
+        }
+        for (const auto& pair : users) {
+            if (!execUpsertUser(query, pair.second)) return false;
+        }
+        return true;
+    });
+}
+
+std::unordered_map<std::string, UserProfile> SqliteStore::loadUsers() {
+    std::unordered_map<std::string, UserProfile> users;
+    QSqlQuery query(connection());
+    if (!query.exec(text(std::string("SELECT ") + kUserColumns + " FROM users"))) {
+        logError("load users", query.lastError());
+        return users;
+    }
+    while (query.next()) {
+        UserProfile user;
+        readUser(query, user);
+        users[user.userId] = user;
+    }
+    return users;
+}
+
+bool SqliteStore::saveUser(const UserProfile& user) {
+    QSqlQuery query(connection());
+    return prepareUpsertUser(query) && execUpsertUser(query, user);
+}
+
+bool SqliteStore::loadUser(const std::string& userId, UserProfile& user) {
+    QSqlQuery query(connection());
+    if (!prepare(query, std::string("SELECT ") + kUserColumns + " FROM users WHERE user_id = ?")) {
+        return false;
+    }
+    query.bindValue(0, text(userId));
+    if (!execPrepared(query, "load user") || !query.next()) {
+        return false;
+    }
+    readUser(query, user);
+    return true;
+}
+
+bool SqliteStore::appendGames(const std::vector<GameState>& games) {
+    return writeBatch({}, games);
+}
+
+bool SqliteStore::saveGameHistory(const std::vector<GameState>& games) {
+    QSqlDatabase db = connection();
+    return inTransaction(db, [&] {
+        QSqlQuery query(db);
+        if (!query.exec("DELETE FROM games") || !prepare(query, kUpsertGame)) {
+            return false;
+        }
+        for (const auto& game : games) {
+            if (!execUpsertGame(query, game)) return false;
+        }
+        return true;
+    });
+}
+
+std::vector<GameState> SqliteStore::loadGameHistory() {
+    QSqlQuery query(connection());
+    query.setForwardOnly(true);
+    if (!query.exec(text(std::string("SELECT ") + kGameColumns + " FROM games ORDER BY seq"))) {
+        logError("load games", query.lastError());
+        return {};
+    }
+    return readGames(query);
+}
+
+// A forward-only query steps through the table row by row, so only the
+// current row is in memory.
+void SqliteStore::forEachGame(const std::function<bool(const GameState&)>& visit) {
+    QSqlQuery query(connection());
+    query.setForwardOnly(true);
+    if (!query.exec(text(std::string("SELECT ") + kGameColumns + " FROM games ORDER BY seq"))) {
+        logError("load games", query.lastError());
+        return;
+    }
+    GameState game;
+    while (query.next()) {
+        if (readGame(query, game) && !visit(game)) {
+            return;
+        }
+    }
+}
+
+// Each half of the union is a range scan of one player index; the second
+// skips games the user played against themselves, which the first found.
+// seq is selected after the game columns only to order ties by save order.
+std::vector<GameState> SqliteStore::loadUserGames(const std::string& userId) {
+    QSqlQuery query(connection());
+    query.setForwardOnly(true);
+    if (!prepare(query, std::string("SELECT ") + kGameColumns + ", seq FROM games WHERE player1_id = ? UNION ALL SELECT " +
+                            kGameColumns + ", seq FROM games WHERE player2_id = ? AND player1_id <> ?" +
+                            " ORDER BY timestamp DESC, seq DESC")) {
+        return {};
+    }
+    bindAll(query, {text(userId), text(userId), text(userId)});
+    if (!execPrepared(query, "load user games")) {
+        return {};
+    }
+    return readGames(query);
+}
+
+bool SqliteStore::loadGame(const std::string& gameId, GameState& game) {
+    QSqlQuery query(connection());
+    if (!prepare(query, std::string("SELECT ") + kGameColumns + " FROM games WHERE game_id = ?")) {
+        return false;
+    }
+    query.bindValue(0, text(gameId));
+    GameState stored;
+    if (!execPrepared(query, "load game") || !query.next() || !readGame(query, stored)) {
+        return false;
+    }
+    game = std::move(stored);
+    return true;
+}
+
+std::size_t SqliteStore::countGames() {
+    QSqlQuery query(connection());
+    if (!query.exec("SELECT COUNT(*) FROM games") || !query.next()) {
+        return 0;
+    }
+    return static_cast<std::size_t>(query.value(0).toLongLong());
+}
+
+bool SqliteStore::writeBatch(const std::unordered_map<std::string, UserProfile>& users,
+                             const std::vector<GameState>& games) {
+    QSqlDatabase db = connection();
+    return inTransaction(db, [&] {
+        if (!users.empty()) {
+            QSqlQuery query(db);
+            if (!prepareUpsertUser(query)) return false;
+            for (const auto& pair : users) {
+                if (!execUpsertUser(query, pair.second)) return false;
+            }
+        }
+        if (!games.empty()) {
+            QSqlQuery query(db);
+            if (!prepare(query, kUpsertGame)) return false;
+            for (const auto& game : games) {
+                if (!execUpsertGame(query, game)) return false;
+            }
+        }
+        return true;
+    });
+}
@@ -0,0 +1,72 @@
+/*
+================================================================================
+File: src/storage_backend.cpp
+Purpose: The storage backend factory and the backend names used to pick one.
+================================================================================
+*/
+#include "storage_backend.h"
+#include "database_manager.h"
+#include "in_memory_store.h"
+#include "sqlite_store.h"
+
+namespace {
+
+const struct {
+    StorageKind kind;
+    const char* name;
+} kStorageKinds[] = {
+    {StorageKind::FlatText, "text"},
+    {StorageKind::BinaryLog, "binary"},
+    {StorageKind::SQLite, "sqlite"},
+    {StorageKind::InMemory, "memory"},
+};
+
+} // namespace
+
+const char* storageKindName(StorageKind kind) {
+    for (const auto& entry : kStorageKinds) {
+        if (entry.kind == kind) return entry.name;
+    }
+    return "";
+}
+
+bool parseStorageKind(const std::string& name, StorageKind& kind) {
+    for (const auto& entry : kStorageKinds) {
+        if (name == entry.name) {
+            kind = entry.kind;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<StorageBackend> openStorage(StorageKind kind, const std::string& path) {
+    switch (kind) {
+    case StorageKind::FlatText:
+    case StorageKind::BinaryLog: {
+        auto db = std::make_unique<DatabaseManager>(path);
+        db->setStorageFormat(kind == StorageKind::FlatText ? DatabaseManager::StorageFormat::Text
+                                                            : DatabaseManager::StorageFormat::Binary);
+        return db;
+    }
+    case StorageKind::SQLite: {
+        auto store = std::make_unique<SqliteStore>(path, true);
+        if (!store->open()) {
+            return nullptr;
+        }
+        // The flat files are read without being repaired or migrated, and
+        // are not written afterwards, so they stay as they were for the
+        // flat-file backends.
+        DatabaseManager flat(path);
+        flat.setReadOnly(true);
+        if (store->isEmpty() && flat.hasFiles()) {
+            store->saveUsers(flat.loadUsers());
+            store->saveGameHistory(flat.loadGameHistory());
+        }
+        return store;
+    }
+    case StorageKind::InMemory:
+        return std::make_unique<InMemoryStore>();
+    }
+    return nullptr;
+}
@@ -0,0 +1,69 @@
+/*
+================================================================================
+File: src/thread_pool.cpp
+Purpose: Implements ThreadPool with one mutex and two condition variables:
+         workers sleep on wakeUp until run() publishes a new generation, and
+         run() sleeps on allDone until the last worker reports back.
+================================================================================
+*/
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount)
+    : currentTask(nullptr), generation(0), pending(0), stopping(false) {
+    for (int i = 1; i < std::max(threadCount, 1); ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return static_cast<int>(threads.size()) + 1;
+}
+
+void ThreadPool::run(const std::function<void(int)>& task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = &task;
+        pending = static_cast<int>(threads.size());
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    task(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    allDone.wait(lock, [this] { return pending == 0; });
+    currentTask = nullptr;
+}
+
+void ThreadPool::workerLoop(int index) {
+    std::uint64_t seenGeneration = 0;
+    for (;;) {
+        const std::function<void(int)>* task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+            task = currentTask;
+        }
+
+        (*task)(index);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            allDone.notify_one();
+        }
+    }
+}
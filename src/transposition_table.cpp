@@ -0,0 +1,106 @@
+/*
+================================================================================
+File: src/transposition_table.cpp
+Purpose: Implements the direct-mapped transposition table. Every key maps to
+         exactly one slot (key & indexMask); a newer store always replaces
+         whatever was in that slot.
+         Each slot is two 64-bit words: the packed entry and key ^ entry.
+         Threads read and write them without locks. If a reader sees halves
+         of two different stores, the XOR no longer gives back the key and
+         the probe counts as a miss, so a torn entry is never used.
+================================================================================
+*/
+#include "transposition_table.h"
+
+namespace {
+
+// Layout of the packed 'data' word.
+constexpr int kScoreShift = 0;     // 16 bits, two's complement
+constexpr int kCellShift = 16;     // 16 bits, two's complement (-1 = none)
+constexpr int kDepthShift = 32;    // 8 bits
+constexpr int kBoundShift = 40;    // 8 bits
+constexpr std::uint64_t kOccupiedBit = std::uint64_t(1) << 48;
+
+std::uint64_t pack(int depth, int score, TranspositionTable::Bound bound, int bestCell) {
+    return (std::uint64_t(std::uint16_t(score)) << kScoreShift) |
+           (std::uint64_t(std::uint16_t(bestCell)) << kCellShift) |
+           (std::uint64_t(std::uint8_t(depth)) << kDepthShift) |
+           (std::uint64_t(bound) << kBoundShift) |
+           kOccupiedBit;
+}
+
+void unpack(std::uint64_t key, std::uint64_t data, TranspositionTable::Entry& entry) {
+    entry.key = key;
+    entry.score = static_cast<std::int16_t>(data >> kScoreShift);
+    entry.bestCell = static_cast<std::int16_t>(data >> kCellShift);
+    entry.depth = static_cast<std::uint8_t>(data >> kDepthShift);
+    entry.bound = static_cast<TranspositionTable::Bound>(std::uint8_t(data >> kBoundShift));
+    entry.occupied = true;
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(std::size_t entryCount) : slotCount(0), indexMask(0) {
+    resize(entryCount);
+}
+
+void TranspositionTable::resize(std::size_t entryCount) {
+    std::size_t capacity = 1;
+    while (capacity < entryCount) {
+        capacity <<= 1;
+    }
+    entries.reset(new Slot[capacity]);
+    slotCount = capacity;
+    indexMask = capacity - 1;
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < slotCount; ++i) {
+        entries[i].check.store(0, std::memory_order_relaxed);
+        entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+std::size_t TranspositionTable::size() const {
+    return slotCount;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, Entry& entry) {
+    const Slot& slot = entries[key & indexMask];
+    const std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+    const std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if ((data & kOccupiedBit) && (check ^ data) == key) {
+        counters.hits.fetch_add(1, std::memory_order_relaxed);
+        unpack(key, data, entry);
+        return true;
+    }
+    counters.misses.fetch_add(1, std::memory_order_relaxed);
+    if (data & kOccupiedBit) {
+        counters.collisions.fetch_add(1, std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, int depth, int score, Bound bound, int bestCell) {
+    Slot& slot = entries[key & indexMask];
+    const std::uint64_t data = pack(depth, score, bound, bestCell);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+    slot.data.store(data, std::memory_order_relaxed);
+    counters.stores.fetch_add(1, std::memory_order_relaxed);
+}
+
+TranspositionTable::Stats TranspositionTable::getStats() const {
+    Stats stats;
+    stats.hits = counters.hits.load(std::memory_order_relaxed);
+    stats.misses = counters.misses.load(std::memory_order_relaxed);
+    stats.collisions = counters.collisions.load(std::memory_order_relaxed);
+    stats.stores = counters.stores.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TranspositionTable::resetStats() {
+    counters.hits.store(0, std::memory_order_relaxed);
+    counters.misses.store(0, std::memory_order_relaxed);
+    counters.collisions.store(0, std::memory_order_relaxed);
+    counters.stores.store(0, std::memory_order_relaxed);
+}
@@ -2,55 +2,364 @@
 ================================================================================
 File: tests/benchmark.cpp
 Purpose: A dedicated command-line executable for performance benchmarking.
-         This corrected version measures time in microseconds to get a more
-         precise and meaningful result for a very fast algorithm.
+         Each scenario is run once per search configuration so minimax,
+         plain alpha-beta, alpha-beta with the transposition table, and the
+         table keyed on symmetry-canonical positions can be compared side by
+         side (time in microseconds, nodes visited, and the table's
+         hit/miss/collision counters). The last configuration answers from
+         the build-time perfect-play table and does no search at all.
+         The large-board rows run iterative deepening under a fixed time
+         budget and report how deep it got (the Depth column). The final
+         search section runs a fixed-depth 15x15 search on 1, 2, 4 and 8
+         threads and prints the speedup over one thread as a second table.
+         The last table saves and loads a synthetic million-game history in
+         the text and binary storage formats, then opens it memory-mapped,
+         then loads each format again on 1, 2, 4 and 8 parsing threads.
+         The durability table times game commits with and without fsync
+         and checks the difference against a per-commit budget. The last
+         table compares the bytes the million games take in memory as
+         GameState objects and packed into a CompactGameStore.
 ================================================================================
 */
 #include "ai_engine.h"
+#include "compact_game_store.h"
+#include "database_manager.h"
+#include "game_history.h"
 #include "game_logic.h"
+#include <algorithm>
+#include <filesystem>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Times a single getBestMove call and prints one CSV row for it.
+static void runScenario(const std::string& name, AIEngine& ai_engine, GameLogic& game_logic) {
+    ai_engine.resetTranspositionStats();
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    ai_engine.getBestMove(game_logic);
+    auto end_time = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    const TranspositionTable::Stats tt = ai_engine.getTranspositionStats();
+    std::cout << name << "," << duration.count() << "," << ai_engine.getLastNodeCount()
+              << "," << tt.hits << "," << tt.misses << "," << tt.collisions
+              << "," << ai_engine.getLastSearchDepth() << std::endl;
+}
+
+static void setupEarlyGame(GameLogic& game_logic) {
+    game_logic.resetBoard();
+    game_logic.makeMove(0, 0); // Player X makes the first move.
+}
+
+static void setupMidGame(GameLogic& game_logic) {
+    game_logic.resetBoard();
+    game_logic.makeMove(0, 0); // X
+    game_logic.makeMove(2, 2); // O (AI)
+    game_logic.makeMove(0, 1); // X (Player is threatening a win on the top row)
+}
+
+// A reproducible history: mostly classic games of 5-9 moves, with every
+// twentieth game played on 15x15.
+static std::vector<GameState> makeSyntheticHistory(int count) {
+    std::mt19937 rng(2024);
+    std::vector<GameState> games(count);
+    int cells[GameLogic::kMaxCellCount];
+    for (int i = 0; i < count; ++i) {
+        GameState& game = games[i];
+        game.gameId = "game-" + std::to_string(10000000 + i);
+        game.player1Id = "user-" + std::to_string(rng() % 1000);
+        game.isAIOpponent = (i % 3 != 0);
+        game.player2Id = game.isAIOpponent ? "AI" : "Player2";
+        game.result = static_cast<GameResult>(1 + rng() % 3);
+        game.durationSeconds = static_cast<int>(rng() % 600);
+        char timestamp[32];
+        std::snprintf(timestamp, sizeof(timestamp), "2024-%02d-%02d %02d:%02d:%02d",
+                      1 + i % 12, 1 + i % 28, i % 24, i % 60, (i / 60) % 60);
+        game.timestamp = timestamp;
+        if (i % 20 == 19) {
+            game.boardSize = 15;
+            game.winLength = 5;
+        }
+        const int cellCount = game.boardSize * game.boardSize;
+        const int moves = (game.boardSize == 3) ? 5 + static_cast<int>(rng() % 5) : 9 + static_cast<int>(rng() % 30);
+        for (int c = 0; c < cellCount; ++c) cells[c] = c;
+        for (int m = 0; m < moves; ++m) {
+            std::swap(cells[m], cells[m + rng() % (cellCount - m)]);
+            game.moveHistory.emplace_back(cells[m] / game.boardSize, cells[m] % game.boardSize);
+        }
+    }
+    return games;
+}
+
+// Bytes one GameState takes: the object, what its strings hold outside
+// their small-string buffer, and its move vector.
+static std::size_t gameStateBytes(const GameState& game) {
+    std::size_t bytes = sizeof(GameState) + game.moveHistory.capacity() * sizeof(Move);
+    for (const std::string* text : {&game.gameId, &game.player1Id, &game.player2Id, &game.timestamp}) {
+        bytes += CompactGameStore::heapBytes(*text);
+    }
+    return bytes;
+}
+
+static long long elapsedMs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::high_resolution_clock::now() - start).count();
+}
 
 int main() {
     // --- Variable Declarations ---
     AIEngine ai_engine;
     GameLogic game_logic;
-    std::chrono::high_resolution_clock::time_point start_time;
-    std::chrono::high_resolution_clock::time_point end_time;
-    
-    // CHANGE #1: We will now store the duration in microseconds.
-    std::chrono::microseconds duration;
+
+    const struct {
+        AIEngine::SearchMode mode;
+        bool useTable;
+        bool useSymmetry;
+        bool useLookup;
+        const char* suffix;
+    } configs[] = {
+        {AIEngine::MINIMAX, false, false, false, "Minimax"},
+        {AIEngine::ALPHA_BETA, false, false, false, "AlphaBeta"},
+        {AIEngine::ALPHA_BETA, true, false, false, "AlphaBetaTT"},
+        {AIEngine::ALPHA_BETA, true, true, false, "AlphaBetaTTSym"},
+        {AIEngine::ALPHA_BETA, true, true, true, "LookupTable"},
+    };
 
     // --- Execution ---
-    // CHANGE #2: Update the header to reflect the new unit (us for microseconds).
-    std::cout << "TestName,Duration(us)" << std::endl;
+    std::cout << "TestName,Duration(us),Nodes,TTHits,TTMisses,TTCollisions,Depth" << std::endl;
 
-    // --- Benchmark Scenario 1: Early-Game Move ---
-    game_logic.resetBoard();
-    game_logic.makeMove(0, 0); // Player X makes the first move.
+    for (const auto& config : configs) {
+        ai_engine.setSearchMode(config.mode);
+        ai_engine.setUseTranspositionTable(config.useTable);
+        ai_engine.setUseSymmetry(config.useSymmetry);
+        ai_engine.setUseLookupTable(config.useLookup);
 
-    start_time = std::chrono::high_resolution_clock::now();
-    ai_engine.getBestMove(game_logic);
-    end_time = std::chrono::high_resolution_clock::now();
-    
-    // CHANGE #3: Cast the result to microseconds instead of milliseconds.
-    duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    std::cout << "Early-Game-Scenario," << duration.count() << std::endl;
+        // --- Benchmark Scenario 0: Opening Move (empty board) ---
+        ai_engine.clearTranspositionTable();
+        game_logic.resetBoard();
+        runScenario(std::string("Opening-Scenario-") + config.suffix, ai_engine, game_logic);
+
+        // --- Benchmark Scenario 1: Early-Game Move ---
+        ai_engine.clearTranspositionTable();
+        setupEarlyGame(game_logic);
+        runScenario(std::string("Early-Game-Scenario-") + config.suffix, ai_engine, game_logic);
 
+        // --- Benchmark Scenario 2: Mid-Game Blocking Move ---
+        ai_engine.clearTranspositionTable();
+        setupMidGame(game_logic);
+        runScenario(std::string("Mid-Game-Blocking-Scenario-") + config.suffix, ai_engine, game_logic);
+    }
 
-    // --- Benchmark Scenario 2: Mid-Game Blocking Move ---
+    // --- Benchmark Scenario 3: Warm Table ---
+    // The table survives between calls, so a whole game's worth of searches
+    // shares one cache. Search the empty board first, then the follow-ups;
+    // the mirrored opening is answered straight from the canonical cache.
+    ai_engine.setSearchMode(AIEngine::ALPHA_BETA);
+    ai_engine.setUseTranspositionTable(true);
+    ai_engine.setUseSymmetry(true);
+    ai_engine.setUseLookupTable(false);
+    ai_engine.clearTranspositionTable();
     game_logic.resetBoard();
-    game_logic.makeMove(0, 0); // X
-    game_logic.makeMove(2, 2); // O (AI)
-    game_logic.makeMove(0, 1); // X (Player is threatening a win on the top row)
-    
-    start_time = std::chrono::high_resolution_clock::now();
-    ai_engine.getBestMove(game_logic);
-    end_time = std::chrono::high_resolution_clock::now();
-    
-    // Also cast this result to microseconds.
-    duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    std::cout << "Mid-Game-Blocking-Scenario," << duration.count() << std::endl;
+    runScenario("Opening-Scenario-AlphaBetaTTSym-Cold", ai_engine, game_logic);
+    setupEarlyGame(game_logic);
+    runScenario("Early-Game-Scenario-AlphaBetaTTSym-Warm", ai_engine, game_logic);
+    game_logic.resetBoard();
+    game_logic.makeMove(2, 2); // Mirror image of the early-game scenario.
+    runScenario("Early-Game-Mirrored-AlphaBetaTTSym-Warm", ai_engine, game_logic);
+    setupMidGame(game_logic);
+    runScenario("Mid-Game-Blocking-Scenario-AlphaBetaTTSym-Warm", ai_engine, game_logic);
+
+    // --- Benchmark Scenario 4: Large Boards Under a Time Budget ---
+    // Each row should take about as long as its budget, never much more.
+    const struct {
+        int boardSize;
+        int winLength;
+        const char* name;
+    } largeBoards[] = {
+        {4, 4, "4x4"},
+        {5, 4, "5x5"},
+        {15, 5, "15x15"},
+    };
+    for (int budgetMs : {100, 500}) {
+        ai_engine.setTimeBudget(std::chrono::milliseconds(budgetMs));
+        for (const auto& board : largeBoards) {
+            GameLogic large(board.boardSize, board.winLength);
+            const int centre = board.boardSize / 2;
+            large.makeMove(centre, centre);         // X
+            large.makeMove(centre - 1, centre);     // O
+            large.makeMove(centre, centre - 1);     // X
+            ai_engine.clearTranspositionTable();
+            runScenario(std::string("Large-Board-") + board.name + "-Budget" + std::to_string(budgetMs) + "ms",
+                        ai_engine, large);
+        }
+    }
+
+    // --- Benchmark Scenario 5: Parallel Search Scaling ---
+    // Fixed depth and no time budget, so every thread count does the same job.
+    constexpr int kScalingDepth = 6;
+    GameLogic gomoku(15, 5);
+    const int opening[][2] = {{7, 7}, {6, 8}, {8, 6}, {6, 6}, {7, 8}, {6, 7}};
+    for (const auto& move : opening) {
+        gomoku.makeMove(move[0], move[1]);
+    }
+    ai_engine.setTimeBudget(std::chrono::milliseconds(0));
+    ai_engine.setDepthLimit(kScalingDepth);
+
+    const int threadCounts[] = {1, 2, 4, 8};
+    long long durations[4] = {};
+    for (int i = 0; i < 4; ++i) {
+        ai_engine.setThreadCount(threadCounts[i]);
+        ai_engine.clearTranspositionTable();
+        auto start_time = std::chrono::high_resolution_clock::now();
+        runScenario("Parallel-15x15-Depth" + std::to_string(kScalingDepth) + "-Threads" +
+                        std::to_string(threadCounts[i]),
+                    ai_engine, gomoku);
+        durations[i] = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::high_resolution_clock::now() - start_time).count();
+    }
+
+    std::cout << std::endl << "Threads,Duration(us),Speedup" << std::endl;
+    for (int i = 0; i < 4; ++i) {
+        std::cout << threadCounts[i] << "," << durations[i] << ","
+                  << static_cast<double>(durations[0]) / std::max(durations[i], 1LL) << std::endl;
+    }
+
+    // --- Benchmark Scenario 6: Game History Persistence ---
+    constexpr int kHistoryGames = 1000000;
+    const std::vector<GameState> history = makeSyntheticHistory(kHistoryGames);
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "tictactoe_benchmark";
+    std::filesystem::create_directories(dir);
+    const std::string dbPath = (dir / "history.db").string();
+
+    const struct {
+        DatabaseManager::StorageFormat format;
+        const char* name;
+    } formats[] = {
+        {DatabaseManager::StorageFormat::Text, "Text"},
+        {DatabaseManager::StorageFormat::Binary, "Binary"},
+    };
+    long long saveMs[2] = {};
+    long long loadMs[2] = {};
+    std::cout << std::endl << "Format,Games,Save(ms),Load(ms),Bytes" << std::endl;
+    for (int i = 0; i < 2; ++i) {
+        std::filesystem::remove(dbPath + ".games");
+        DatabaseManager db(dbPath);
+        db.setStorageFormat(formats[i].format);
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        db.saveGameHistory(history);
+        saveMs[i] = elapsedMs(start_time);
+
+        start_time = std::chrono::high_resolution_clock::now();
+        const std::size_t loaded = db.loadGameHistory().size();
+        loadMs[i] = elapsedMs(start_time);
+
+        std::cout << formats[i].name << "," << loaded << "," << saveMs[i] << "," << loadMs[i] << ","
+                  << std::filesystem::file_size(dbPath + ".games") << std::endl;
+    }
+    std::cout << "Binary speedup: save " << static_cast<double>(saveMs[0]) / std::max(saveMs[1], 1LL)
+              << "x, load " << static_cast<double>(loadMs[0]) / std::max(loadMs[1], 1LL) << "x" << std::endl;
+
+    // The mapped archive only indexes record boundaries up front; listing one
+    // player's games then decodes just those records.
+    {
+        DatabaseManager db(dbPath);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        GameHistory mapped;
+        mapped.loadFromDatabase(db);
+        const long long openMs = elapsedMs(start_time);
+
+        start_time = std::chrono::high_resolution_clock::now();
+        const std::size_t userGames = mapped.getUserGames(history.front().player1Id).size();
+        const long long userMs = elapsedMs(start_time);
+        // Later lookups for the same user are answered from the index.
+        start_time = std::chrono::high_resolution_clock::now();
+        mapped.getUserGames(history.front().player1Id);
+        const long long repeatUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                       std::chrono::high_resolution_clock::now() - start_time).count();
+        std::cout << "Mapped," << mapped.getGameCount() << ",-," << openMs << ","
+                  << std::filesystem::file_size(dbPath + ".games") << std::endl;
+        std::cout << "Mapped user lookup: " << userGames << " games in " << userMs << " ms, then " << repeatUs
+                  << " us from the index" << std::endl;
+    }
+
+    // Load time against the number of parsing threads; one thread is the
+    // sequential parser.
+    std::cout << std::endl << "Format,LoadThreads,Load(ms),Speedup" << std::endl;
+    for (const auto& format : formats) {
+        std::filesystem::remove(dbPath + ".games");
+        DatabaseManager db(dbPath);
+        db.setStorageFormat(format.format);
+        db.setSyncWrites(false);
+        db.saveGameHistory(history);
+        long long loadThreadsMs[4] = {};
+        for (int i = 0; i < 4; ++i) {
+            db.setLoadThreads(threadCounts[i]);
+            auto start_time = std::chrono::high_resolution_clock::now();
+            db.loadGameHistory();
+            loadThreadsMs[i] = elapsedMs(start_time);
+            std::cout << format.name << "," << threadCounts[i] << "," << loadThreadsMs[i] << ","
+                      << static_cast<double>(loadThreadsMs[0]) / std::max(loadThreadsMs[i], 1LL) << std::endl;
+        }
+    }
+
+    // --- Benchmark Scenario 7: Durable Commit Cost ---
+    // One commit is what handleGameOver persists: the player's profile and
+    // the finished game. With sync on, both are fsynced before returning.
+    constexpr int kCommits = 200;
+    constexpr long long kCommitBudgetUs = 10000;
+    long long commitUs[2] = {};
+    std::cout << std::endl << "Sync,Commits,Total(us),PerCommit(us)" << std::endl;
+    for (int sync = 0; sync < 2; ++sync) {
+        std::filesystem::remove(dbPath + ".games");
+        std::filesystem::remove(dbPath + ".users");
+        std::filesystem::remove(dbPath + ".users.wal");
+        DatabaseManager db(dbPath);
+        db.setSyncWrites(sync == 1);
+        UserProfile player;
+        player.userId = "user-0";
+        player.username = "benchmark";
+        player.passwordHash = std::string(64, '0');
+        db.saveUsers({{player.userId, player}});
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < kCommits; ++i) {
+            player.gamesPlayed++;
+            db.saveUser(player);
+            db.appendGame(history[i]);
+        }
+        const long long totalUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::high_resolution_clock::now() - start_time).count();
+        commitUs[sync] = totalUs / kCommits;
+        std::cout << (sync ? "On" : "Off") << "," << kCommits << "," << totalUs << "," << commitUs[sync] << std::endl;
+    }
+    const long long overheadUs = commitUs[1] - commitUs[0];
+    std::cout << "Durability overhead per commit: " << overheadUs << " us (budget " << kCommitBudgetUs << " us, "
+              << (overheadUs <= kCommitBudgetUs ? "within" : "OVER") << " budget)" << std::endl;
+    std::filesystem::remove_all(dir);
+
+    // --- Benchmark Scenario 8: In-Memory Layout ---
+    std::size_t gameStateTotal = history.capacity() * sizeof(GameState) - history.size() * sizeof(GameState);
+    for (const GameState& game : history) {
+        gameStateTotal += gameStateBytes(game);
+    }
+    CompactGameStore compact;
+    compact.reserve(history.size());
+    for (const GameState& game : history) {
+        compact.append(game);
+    }
+    const std::size_t compactTotal = compact.memoryBytes();
+    std::cout << std::endl << "Layout,Games,Bytes,BytesPerGame" << std::endl;
+    std::cout << "GameState," << history.size() << "," << gameStateTotal << ","
+              << gameStateTotal / history.size() << std::endl;
+    std::cout << "Compact," << compact.size() << "," << compactTotal << "," << compactTotal / compact.size()
+              << std::endl;
+    std::cout << "Compact layout: " << static_cast<double>(gameStateTotal) / std::max<std::size_t>(compactTotal, 1)
+              << "x smaller" << std::endl;
 
     return 0;
-}
\ No newline at end of file
+}
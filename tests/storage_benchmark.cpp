@@ -0,0 +1,159 @@
+/*
+================================================================================
+File: tests/storage_benchmark.cpp
+Purpose: Runs identical storage workloads against every StorageBackend and
+         prints one CSV row per backend:
+
+           BulkInsert   the synthetic history saved in batches of games
+           PointUpdate  one user's profile saved (average of many)
+           UserHistory  one user's games listed newest first (average)
+           ColdLoad     a fresh backend opened on the same path, then all
+                        users and games loaded (the OS page cache may still
+                        hold the files; the in-memory backend has nothing to
+                        reopen)
+
+         Writes are synced, as in the application. The number of games can
+         be given as the first argument.
+================================================================================
+*/
+#include "storage_backend.h"
+#include <QCoreApplication>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kDefaultGames = 100000;
+constexpr int kUsers = 1000;
+constexpr std::size_t kInsertBatch = 1000;
+constexpr int kPointUpdates = 200;
+constexpr int kHistoryQueries = 10;
+
+std::string userId(int index) {
+    return "user-" + std::to_string(index);
+}
+
+std::vector<GameState> makeSyntheticHistory(int count) {
+    std::mt19937 rng(2024);
+    std::vector<GameState> games(count);
+    for (int i = 0; i < count; ++i) {
+        GameState& game = games[i];
+        game.gameId = "game-" + std::to_string(10000000 + i);
+        game.player1Id = userId(static_cast<int>(rng() % kUsers));
+        game.isAIOpponent = (i % 3 != 0);
+        game.player2Id = game.isAIOpponent ? "AI" : userId(static_cast<int>(rng() % kUsers));
+        game.result = static_cast<GameResult>(1 + rng() % 3);
+        game.durationSeconds = static_cast<int>(rng() % 600);
+        char timestamp[32];
+        std::snprintf(timestamp, sizeof(timestamp), "2024-%02d-%02d %02d:%02d:%02d",
+                      1 + i % 12, 1 + i % 28, i % 24, i % 60, (i / 60) % 60);
+        game.timestamp = timestamp;
+        int cells[9] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+        std::shuffle(cells, cells + 9, rng);
+        const int moves = 5 + static_cast<int>(rng() % 5);
+        for (int m = 0; m < moves; ++m) {
+            game.moveHistory.emplace_back(cells[m] / 3, cells[m] % 3);
+        }
+    }
+    return games;
+}
+
+long long elapsedUs(std::chrono::high_resolution_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// Total size of the files a backend created in 'dir'.
+std::uintmax_t bytesOnDisk(const std::filesystem::path& dir) {
+    std::uintmax_t bytes = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (entry.is_regular_file()) bytes += entry.file_size();
+    }
+    return bytes;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    // The SQLite driver is a plugin, which needs an application object.
+    QCoreApplication app(argc, argv);
+    const int gameCount = argc > 1 ? std::max(1, std::atoi(argv[1])) : kDefaultGames;
+
+    const std::vector<GameState> history = makeSyntheticHistory(gameCount);
+    std::unordered_map<std::string, UserProfile> users;
+    for (int i = 0; i < kUsers; ++i) {
+        UserProfile user;
+        user.userId = userId(i);
+        user.username = "player" + std::to_string(i);
+        user.passwordHash = std::string(64, '0');
+        users[user.userId] = user;
+    }
+
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "tictactoe_storage_benchmark";
+    std::cout << "Backend,Games,BulkInsert(ms),PointUpdate(us),UserHistory(us),ColdLoad(ms),Bytes" << std::endl;
+    for (const StorageKind kind : {StorageKind::FlatText, StorageKind::BinaryLog, StorageKind::SQLite,
+                                   StorageKind::InMemory}) {
+        const std::filesystem::path dir = root / storageKindName(kind);
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+        const std::string path = (dir / "store.db").string();
+
+        std::unique_ptr<StorageBackend> storage = openStorage(kind, path);
+        if (!storage) {
+            std::cout << storageKindName(kind) << ",could not be opened" << std::endl;
+            continue;
+        }
+        std::unordered_map<std::string, UserProfile> profiles = users;
+        storage->saveUsers(profiles);
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        for (std::size_t first = 0; first < history.size(); first += kInsertBatch) {
+            const std::size_t last = std::min(history.size(), first + kInsertBatch);
+            storage->appendGames(std::vector<GameState>(history.begin() + first, history.begin() + last));
+        }
+        const long long insertMs = elapsedUs(start_time) / 1000;
+
+        // The same users, in the same order, for every backend.
+        std::mt19937 rng(7);
+        start_time = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < kPointUpdates; ++i) {
+            UserProfile& user = profiles[userId(static_cast<int>(rng() % kUsers))];
+            user.gamesPlayed++;
+            storage->saveUser(user);
+        }
+        const long long updateUs = elapsedUs(start_time) / kPointUpdates;
+
+        start_time = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < kHistoryQueries; ++i) {
+            storage->loadUserGames(userId(static_cast<int>(rng() % kUsers)));
+        }
+        const long long queryUs = elapsedUs(start_time) / kHistoryQueries;
+
+        std::string coldLoad = "-";
+        if (kind != StorageKind::InMemory) {
+            storage.reset();
+            start_time = std::chrono::high_resolution_clock::now();
+            storage = openStorage(kind, path);
+            const std::size_t loadedUsers = storage ? storage->loadUsers().size() : 0;
+            const std::size_t loadedGames = storage ? storage->loadGameHistory().size() : 0;
+            coldLoad = std::to_string(elapsedUs(start_time) / 1000);
+            if (loadedUsers != users.size() || loadedGames != history.size()) {
+                std::cerr << storageKindName(kind) << ": reloaded " << loadedUsers << " users and " << loadedGames
+                          << " games" << std::endl;
+            }
+        }
+        storage.reset();
+
+        std::cout << storageKindName(kind) << "," << history.size() << "," << insertMs << "," << updateUs << ","
+                  << queryUs << "," << coldLoad << "," << bytesOnDisk(dir) << std::endl;
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
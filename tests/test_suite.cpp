@@ -7,9 +7,29 @@ Description: A comprehensive test suite using the Qt Test framework. This suite
 ================================================================================
 */
 #include <QtTest>
+#include <QSqlDatabase>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <thread>
 
+#include "compact_game_store.h"
 #include "game_logic.h"
+#include "game_history.h"
+#include "game_history_model.h"
+#include "in_memory_store.h"
 #include "ai_engine.h"
+#include "board_symmetry.h"
+#include "database_manager.h"
+#include "durable_file.h"
+#include "mapped_game_log.h"
+#include "perfect_play.h"
+#include "persistence_writer.h"
+#include "record_format.h"
+#include "storage_backend.h"
+#include "transposition_table.h"
 #include "user_auth.h"
 
 class TestSuite : public QObject
@@ -26,6 +46,51 @@ private slots:
     void testValidMove();
     void testWinCondition();
     void testDrawCondition();
+    void testWinningCombination();
+    void testAvailableMovesAfterUndo();
+    void testLargeBoardWinLength();
+    void testUndoReopensDecidedGame();
+    void testLineCountersUndoExactly();
+
+    // AI Strategy Tests
+    void testAIBlocksWin();
+    void testAlphaBetaTakesFastestWin();
+    void testTranspositionTableReuse();
+    void testCanonicalizationIsSymmetryInvariant();
+    void testMirroredPositionUsesCanonicalCache();
+    void testPerfectPlayTableMatchesSearch();
+    void testStopFlagCancelsSearch();
+    void testAIBlocksOnLargeBoard();
+    void testTimeBudgetBoundsSearch();
+    void testParallelSearchMatchesSerial();
+    void testTranspositionTableConcurrentAccess();
+
+    // Persistence Tests
+    void testGameLogAppendRoundTrip();
+    void testGameLogDropsTornTail();
+    void testGameLogSkipsDamagedRecord();
+    void testGameLogCompaction();
+    void testUserStoreUpdatesInPlace();
+    void testUserStoreMigratesLegacyRecords();
+    void testBinaryGameRecordRoundTrip();
+    void testTextHistoryMigratesToBinary();
+    void testMappedGameLogDecodesOnDemand();
+    void testGameHistoryReadsFromMappedLog();
+    void testPersistenceWriterCoalescesUpdates();
+    void testPersistenceWriterFlushesOnDestruction();
+    void testUserJournalRepairsTornUpdate();
+    void testAtomicWriteReplacesWholeFile();
+    void testSqliteEngineIndexedQueries();
+    void testSqliteEngineImportsFlatFiles();
+    void testStorageBackendsAgree();
+    void testStreamingReaderSpansChunks();
+    void testGameHistoryLoadsRecentGamesEagerly();
+    void testParallelLoadMatchesSequential();
+    void testUserGamesIndexedByTime();
+    void testGameByIdUsesHashIndex();
+    void testHistoryModelFetchesLazily();
+    void testReplayCursorScrubs();
+    void testCompactGameStoreRoundTrips();
 
     // User Authentication Tests
     void testSuccessfulRegistrationAndLogin();
@@ -76,6 +141,1550 @@ void TestSuite::testDrawCondition() {
     QCOMPARE(game.checkGameResult(), GameResult::DRAW);
 }
 
+void TestSuite::testWinningCombination() {
+    game.resetBoard();
+    game.makeMove(0, 2); // X
+    game.makeMove(0, 0); // O
+    game.makeMove(1, 1); // X
+    game.makeMove(0, 1); // O
+    game.makeMove(2, 0); // X wins on the anti-diagonal
+    QCOMPARE(game.checkGameResult(), GameResult::X_WINS);
+    std::vector<Move> cells = game.findWinningCombination();
+    QCOMPARE(static_cast<int>(cells.size()), 3);
+    for (const auto& cell : cells) {
+        QCOMPARE(cell.row + cell.col, 2);
+    }
+}
+
+void TestSuite::testAvailableMovesAfterUndo() {
+    game.resetBoard();
+    game.makeMove(1, 1);
+    game.makeMove(0, 0);
+    MoveList moves;
+    game.getAvailableMoves(moves);
+    QCOMPARE(moves.size(), 7);
+    QCOMPARE(static_cast<int>(game.getAvailableMoves().size()), 7);
+
+    game.undoLastMove();
+    QCOMPARE(game.getCell(0, 0), Player::NONE);
+    QCOMPARE(game.getCurrentPlayer(), Player::O);
+    game.getAvailableMoves(moves);
+    QCOMPARE(moves.size(), 8);
+    QCOMPARE(game.getOccupiedBits(), static_cast<Bitboard>(1u << GameLogic::cellIndex(1, 1)));
+}
+
+void TestSuite::testLargeBoardWinLength() {
+    // 5x5, four in a row: three stones are not enough, the fourth wins.
+    GameLogic big(5, 4);
+    QCOMPARE(big.getCellCount(), 25);
+    big.makeMove(1, 0); big.makeMove(0, 0); // X, O
+    big.makeMove(2, 1); big.makeMove(0, 1);
+    big.makeMove(3, 2); big.makeMove(0, 2);
+    QCOMPARE(big.checkGameResult(), GameResult::IN_PROGRESS);
+    big.makeMove(4, 3); // X completes the diagonal (1,0)-(4,3)
+    QCOMPARE(big.checkGameResult(), GameResult::X_WINS);
+    std::vector<Move> cells = big.findWinningCombination();
+    QCOMPARE(static_cast<int>(cells.size()), 4);
+    for (const auto& cell : cells) {
+        QCOMPARE(cell.row - cell.col, 1);
+    }
+
+    // Gomoku: five in a row on 15x15, found from a move in the middle of the line.
+    GameLogic gomoku(15, 5);
+    const int cols[] = {3, 4, 6, 7};
+    for (int i = 0; i < 4; ++i) {
+        gomoku.makeMove(7, cols[i]);
+        gomoku.makeMove(0, i);
+    }
+    QCOMPARE(gomoku.checkGameResult(), GameResult::IN_PROGRESS);
+    gomoku.makeMove(7, 5);
+    QCOMPARE(gomoku.checkGameResult(), GameResult::X_WINS);
+    QCOMPARE(static_cast<int>(gomoku.findWinningCombination().size()), 5);
+}
+
+void TestSuite::testUndoReopensDecidedGame() {
+    GameLogic big(4, 4);
+    for (int col = 0; col < 3; ++col) {
+        big.makeMove(0, col);
+        big.makeMove(1, col);
+    }
+    big.makeMove(0, 3);
+    QCOMPARE(big.checkGameResult(), GameResult::X_WINS);
+    big.undoLastMove();
+    QCOMPARE(big.checkGameResult(), GameResult::IN_PROGRESS);
+    QCOMPARE(big.getCurrentPlayer(), Player::X);
+
+    // Out-of-range configurations are clamped rather than rejected.
+    big.setBoardConfig(40, 9);
+    QCOMPARE(big.getBoardSize(), GameLogic::kMaxBoardSize);
+    QCOMPARE(big.getWinLength(), 9);
+    QVERIFY(!big.isClassic());
+}
+
+void TestSuite::testLineCountersUndoExactly() {
+    GameLogic big(5, 4);
+    const std::vector<std::uint8_t> emptyX = big.getLineCounts(Player::X);
+    // 2 windows in each of 5 rows and 5 columns, 2x2 starts per diagonal direction.
+    QCOMPARE(big.getLineTable().lineCount(), 2 * (5 * 2) + 2 * (2 * 2));
+
+    const int moves[][2] = {{2, 2}, {0, 0}, {2, 3}, {4, 4}, {1, 2}, {3, 0}};
+    std::vector<std::vector<std::uint8_t>> xSnapshots;
+    std::vector<std::vector<std::uint8_t>> oSnapshots;
+    for (const auto& move : moves) {
+        xSnapshots.push_back(big.getLineCounts(Player::X));
+        oSnapshots.push_back(big.getLineCounts(Player::O));
+        big.makeMove(move[0], move[1]);
+    }
+    // (2, 2) lies on its row, its column and both diagonals, in several
+    // windows each; X's count went up on every one of them.
+    const LineTable& table = big.getLineTable();
+    const int centre = GameLogic::cellIndex(2, 2, 5);
+    for (int i = table.cellLineBegin[centre]; i < table.cellLineBegin[centre + 1]; ++i) {
+        QVERIFY(big.getLineCounts(Player::X)[table.cellLines[i]] >= 1);
+    }
+
+    for (int i = 5; i >= 0; --i) {
+        big.undoLastMove();
+        QVERIFY(big.getLineCounts(Player::X) == xSnapshots[i]);
+        QVERIFY(big.getLineCounts(Player::O) == oSnapshots[i]);
+    }
+    QVERIFY(big.getLineCounts(Player::X) == emptyX);
+    QVERIFY(!big.isBoardFull());
+}
+
+void TestSuite::testAIBlocksWin() {
+    AIEngine ai;
+    ai.setUseLookupTable(false); // Compare the two searches, not the table.
+    game.resetBoard();
+    game.makeMove(0, 0); // X
+    game.makeMove(2, 2); // O
+    game.makeMove(0, 1); // X threatens the top row
+
+    ai.setSearchMode(AIEngine::MINIMAX);
+    Move minimaxMove = ai.getBestMove(game);
+    long long minimaxNodes = ai.getLastNodeCount();
+
+    ai.setSearchMode(AIEngine::ALPHA_BETA);
+    Move alphaBetaMove = ai.getBestMove(game);
+
+    QCOMPARE(minimaxMove.row, 0);
+    QCOMPARE(minimaxMove.col, 2);
+    QCOMPARE(alphaBetaMove.row, 0);
+    QCOMPARE(alphaBetaMove.col, 2);
+    QVERIFY(ai.getLastNodeCount() < minimaxNodes);
+}
+
+void TestSuite::testAlphaBetaTakesFastestWin() {
+    AIEngine ai;
+    game.resetBoard();
+    game.makeMove(0, 0); // X
+    game.makeMove(1, 1); // O
+    game.makeMove(2, 2); // X
+    game.makeMove(0, 2); // O
+    game.makeMove(1, 0); // X
+    // O can win at once on the anti-diagonal; any slower plan is worse.
+    Move move = ai.getBestMove(game);
+    QCOMPARE(move.row, 2);
+    QCOMPARE(move.col, 0);
+}
+
+void TestSuite::testTranspositionTableReuse() {
+    AIEngine ai;
+    ai.setUseLookupTable(false);
+    ai.setUseSymmetry(false); // Exercise the Zobrist-keyed table on its own.
+    game.resetBoard();
+    game.makeMove(0, 0); // X
+    std::uint64_t key = game.getHashKey();
+    game.makeMove(1, 1);
+    game.undoLastMove();
+    QCOMPARE(game.getHashKey(), key); // Undo restores the Zobrist key exactly.
+
+    Move first = ai.getBestMove(game);
+    long long coldNodes = ai.getLastNodeCount();
+    ai.resetTranspositionStats();
+
+    // The table is kept between calls, so the same search is answered from it.
+    Move second = ai.getBestMove(game);
+    QCOMPARE(second.row, first.row);
+    QCOMPARE(second.col, first.col);
+    QVERIFY(ai.getLastNodeCount() < coldNodes);
+    QVERIFY(ai.getTranspositionStats().hits > 0);
+}
+
+void TestSuite::testCanonicalizationIsSymmetryInvariant() {
+    game.resetBoard();
+    game.makeMove(0, 1); // X
+    game.makeMove(2, 2); // O
+    game.makeMove(1, 0); // X
+    Bitboard x = game.getPlayerBits(Player::X);
+    Bitboard o = game.getPlayerBits(Player::O);
+    std::uint32_t key = symmetry::canonicalize(x, o).key;
+
+    for (int t = 0; t < symmetry::kTransformCount; ++t) {
+        Bitboard tx = symmetry::transformBits(x, t);
+        Bitboard to = symmetry::transformBits(o, t);
+        QCOMPARE(symmetry::canonicalize(tx, to).key, key);
+        for (int cell = 0; cell < GameLogic::kClassicCellCount; ++cell) {
+            QCOMPARE(symmetry::inverseCell(symmetry::transformCell(cell, t), t), cell);
+        }
+    }
+}
+
+void TestSuite::testMirroredPositionUsesCanonicalCache() {
+    AIEngine ai;
+    ai.setUseLookupTable(false);
+    game.resetBoard();
+    game.makeMove(0, 0); // X takes a corner
+    Move reply = ai.getBestMove(game);
+    QVERIFY(ai.getLastNodeCount() > 0);
+
+    game.resetBoard();
+    game.makeMove(2, 2); // The opposite corner is the same position rotated 180 degrees
+    Move mirrored = ai.getBestMove(game);
+    QCOMPARE(ai.getLastNodeCount(), 0LL); // Answered from the cache, no search.
+    QCOMPARE(mirrored.row, 2 - reply.row);
+    QCOMPARE(mirrored.col, 2 - reply.col);
+}
+
+void TestSuite::testPerfectPlayTableMatchesSearch() {
+    // The live reference minimax, which plays for O.
+    AIEngine ai;
+    ai.setUseLookupTable(false);
+    ai.setSearchMode(AIEngine::MINIMAX);
+
+    // Value of a position for the side to move (1 win, 0 draw, -1 loss),
+    // taken over every reply so it doesn't depend on any move order.
+    constexpr int kUnknown = 2;
+    std::vector<int> values(perfect_play::kPositionCount, kUnknown);
+    std::function<int()> value = [&]() {
+        int& known = values[perfect_play::encode(game.getPlayerBits(Player::X), game.getPlayerBits(Player::O))];
+        if (known != kUnknown) return known;
+        const GameResult result = game.checkGameResult();
+        if (result == GameResult::IN_PROGRESS) {
+            known = -1;
+            for (const auto& move : game.getAvailableMoves()) {
+                game.makeMove(move.row, move.col);
+                known = std::max(known, -value());
+                game.undoLastMove();
+            }
+        } else {
+            known = result == GameResult::DRAW ? 0 : -1; // The side to move has lost.
+        }
+        return known;
+    };
+    // Value for the side to move of playing 'cell', or kUnknown if it's taken.
+    auto valueAfter = [&](int cell) {
+        if (cell < 0 || !game.makeMove(cell / GameLogic::kClassicBoardSize, cell % GameLogic::kClassicBoardSize)) {
+            return kUnknown;
+        }
+        const int after = -value();
+        game.undoLastMove();
+        return after;
+    };
+
+    std::vector<bool> visited(perfect_play::kPositionCount, false);
+    int checked = 0;
+    int mismatches = 0;
+    game.resetBoard();
+
+    // The table may break ties differently from any search; it only has to
+    // pick a move that keeps the position's value.
+    std::function<void()> visit = [&]() {
+        Bitboard x = game.getPlayerBits(Player::X);
+        Bitboard o = game.getPlayerBits(Player::O);
+        int code = perfect_play::encode(x, o);
+        if (visited[code]) return;
+        visited[code] = true;
+
+        int tableCell = perfect_play::bestCell(x, o);
+        if (game.checkGameResult() != GameResult::IN_PROGRESS) {
+            if (tableCell != -1) mismatches++;
+            return;
+        }
+        checked++;
+        const int best = value();
+        if (valueAfter(tableCell) != best) mismatches++;
+        if (game.getCurrentPlayer() == Player::O) {
+            Move searched = ai.getBestMove(game);
+            if (valueAfter(GameLogic::cellIndex(searched.row, searched.col)) != best) mismatches++;
+        }
+
+        for (const auto& move : game.getAvailableMoves()) {
+            game.makeMove(move.row, move.col);
+            visit();
+            game.undoLastMove();
+        }
+    };
+    visit();
+
+    QCOMPARE(checked, 4520); // Every non-terminal position reachable in a legal game.
+    QCOMPARE(mismatches, 0);
+}
+
+void TestSuite::testStopFlagCancelsSearch() {
+    AIEngine ai;
+    ai.setUseLookupTable(false);
+    std::atomic<bool> stop(true);
+    ai.setStopFlag(&stop);
+
+    game.resetBoard();
+    game.makeMove(0, 0); // X
+    game.makeMove(2, 2); // O
+    game.makeMove(0, 1); // X threatens the top row
+    Move cancelled = ai.getBestMove(game);
+    QCOMPARE(cancelled.row, -1);
+    QCOMPARE(game.getMoveHistory().size(), size_t(3)); // The board is left as it was.
+
+    // A cancelled search must not leave partial results in the caches.
+    stop = false;
+    Move move = ai.getBestMove(game);
+    QCOMPARE(move.row, 0);
+    QCOMPARE(move.col, 2);
+}
+
+void TestSuite::testAIBlocksOnLargeBoard() {
+    AIEngine ai;
+    GameLogic gomoku(15, 5);
+    // X builds four in row 7 whose left end O has already closed.
+    gomoku.makeMove(7, 5); gomoku.makeMove(7, 4);
+    gomoku.makeMove(7, 6); gomoku.makeMove(10, 0);
+    gomoku.makeMove(7, 7); gomoku.makeMove(10, 2);
+    gomoku.makeMove(7, 8);
+
+    // O to move has exactly one way not to lose.
+    Move move = ai.getBestMove(gomoku);
+    QCOMPARE(move.row, 7);
+    QCOMPARE(move.col, 9);
+
+    // If O plays elsewhere instead, X completes the five.
+    gomoku.makeMove(12, 12);
+    move = ai.getBestMove(gomoku);
+    QCOMPARE(move.row, 7);
+    QCOMPARE(move.col, 9);
+}
+
+void TestSuite::testTimeBudgetBoundsSearch() {
+    AIEngine ai;
+    ai.setTimeBudget(std::chrono::milliseconds(50));
+    GameLogic gomoku(15, 5);
+    gomoku.makeMove(7, 7); gomoku.makeMove(6, 8);
+    gomoku.makeMove(8, 6); gomoku.makeMove(6, 6);
+
+    auto start = std::chrono::steady_clock::now();
+    Move move = ai.getBestMove(gomoku);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    QVERIFY(gomoku.isValidMove(move.row, move.col));
+    QVERIFY(ai.getLastSearchDepth() >= 1);
+    // Generous, so a loaded machine doesn't fail it; a search that ignored
+    // the budget would keep deepening for minutes.
+    QVERIFY(elapsed < std::chrono::seconds(1));
+
+    // Twenty times the budget is worth at least one more ply (each ply costs
+    // a few times the one before).
+    const int shallowDepth = ai.getLastSearchDepth();
+    ai.clearTranspositionTable();
+    ai.setTimeBudget(std::chrono::milliseconds(1000));
+    ai.getBestMove(gomoku);
+    QVERIFY(ai.getLastSearchDepth() > shallowDepth);
+}
+
+void TestSuite::testParallelSearchMatchesSerial() {
+    GameLogic gomoku(15, 5);
+    gomoku.makeMove(7, 5); gomoku.makeMove(7, 4);
+    gomoku.makeMove(7, 6); gomoku.makeMove(10, 0);
+    gomoku.makeMove(7, 7); gomoku.makeMove(10, 2);
+    gomoku.makeMove(7, 8);
+
+    for (int threads : {1, 4}) {
+        AIEngine ai;
+        ai.setThreadCount(threads);
+        ai.setTimeBudget(std::chrono::milliseconds(0));
+        ai.setDepthLimit(3);
+        Move move = ai.getBestMove(gomoku);
+        QCOMPARE(move.row, 7);
+        QCOMPARE(move.col, 9); // The only block.
+        QCOMPARE(ai.getLastSearchDepth(), 3);
+        QCOMPARE(gomoku.getMoveHistory().size(), size_t(7));
+    }
+}
+
+void TestSuite::testTranspositionTableConcurrentAccess() {
+    // Writers race on a tiny table; every hit must still be self-consistent.
+    TranspositionTable table(64);
+    std::atomic<int> badReads(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&table, &badReads, t]() {
+            for (std::uint64_t i = 0; i < 20000; ++i) {
+                const std::uint64_t key = (i * 4 + t) * 0x9E3779B97F4A7C15ull;
+                const int score = static_cast<int>(key >> 50);
+                table.store(key, score & 63, score, TranspositionTable::EXACT, score & 255);
+                TranspositionTable::Entry entry;
+                if (table.probe(key ^ 0x40, entry) || table.probe(key, entry)) {
+                    const int expected = static_cast<int>(entry.key >> 50);
+                    if (entry.score != expected || entry.depth != (expected & 63) || entry.bestCell != (expected & 255)) {
+                        badReads++;
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+    QCOMPARE(badReads.load(), 0);
+    QVERIFY(table.getStats().stores == 4 * 20000);
+}
+
+namespace {
+
+GameState makeTestGame(const std::string& id, int boardSize = 3, int winLength = 3) {
+    GameState game;
+    game.gameId = id;
+    game.player1Id = "user-1";
+    game.player2Id = "AI";
+    game.isAIOpponent = true;
+    game.result = GameResult::X_WINS;
+    game.timestamp = "2024-01-01 12:00:00";
+    game.moveHistory = {Move(0, 0), Move(1, 1), Move(0, 1), Move(2, 2), Move(0, 2)};
+    game.boardSize = boardSize;
+    game.winLength = winLength;
+    return game;
+}
+
+// A backend GameHistory can only stream, which counts the games it streams.
+class StreamOnlyStore : public InMemoryStore {
+public:
+    std::size_t streamed = 0;
+
+    void forEachGame(const std::function<bool(const GameState&)>& visit) override {
+        InMemoryStore::forEachGame([&](const GameState& game) {
+            streamed++;
+            return visit(game);
+        });
+    }
+    bool hasIndexedLookups() const override { return false; }
+};
+
+} // namespace
+
+void TestSuite::testGameLogAppendRoundTrip() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    {
+        DatabaseManager db(path);
+        QVERIFY(db.appendGame(makeTestGame("game-a")));
+        QVERIFY(db.appendGame(makeTestGame("game-b", 15, 5)));
+    }
+    DatabaseManager db(path);
+    std::vector<GameState> games = db.loadGameHistory();
+    QCOMPARE(games.size(), size_t(2));
+    QCOMPARE(games[0].gameId, std::string("game-a"));
+    QCOMPARE(games[1].boardSize, 15);
+    QCOMPARE(games[1].winLength, 5);
+    QCOMPARE(games[1].moveHistory.size(), size_t(5));
+    QCOMPARE(games[1].moveHistory[3].col, 2);
+    QCOMPARE(db.getGameLogStats().deadRecords, size_t(0));
+}
+
+void TestSuite::testGameLogDropsTornTail() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    DatabaseManager db(path);
+    QVERIFY(db.appendGame(makeTestGame("game-a")));
+    QVERIFY(db.appendGame(makeTestGame("game-b")));
+    const auto intactSize = std::filesystem::file_size(path + ".games");
+    {
+        // A crash part-way through an append leaves a partial record.
+        std::ofstream file(path + ".games", std::ios::binary | std::ios::app);
+        file << "game-c|user-1|AI|1|1|2024-01-01 12:";
+    }
+
+    QCOMPARE(db.loadGameHistory().size(), size_t(2));
+    QVERIFY(db.getGameLogStats().truncatedBytes > 0);
+    QCOMPARE(std::filesystem::file_size(path + ".games"), intactSize);
+
+    // The next append starts on a clean record boundary.
+    QVERIFY(db.appendGame(makeTestGame("game-c")));
+    std::vector<GameState> games = db.loadGameHistory();
+    QCOMPARE(games.size(), size_t(3));
+    QCOMPARE(games[2].gameId, std::string("game-c"));
+}
+
+void TestSuite::testGameLogSkipsDamagedRecord() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    std::vector<GameState> games;
+    for (int i = 0; i < 40000; ++i) {
+        games.push_back(makeTestGame("game-" + std::to_string(i)));
+    }
+    {
+        DatabaseManager db(path);
+        db.setSyncWrites(false);
+        QVERIFY(db.saveGameHistory(games));
+    }
+    // Give a record in the middle a length prefix that runs past the end of
+    // the file, as if a byte had flipped on disk.
+    std::string damaged;
+    {
+        std::ifstream file(path + ".games", std::ios::binary);
+        damaged.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::string before;
+    for (int i = 0; i < 20000; ++i) {
+        record_format::appendGameRecord(before, games[i]);
+    }
+    const std::size_t middle = record_format::kHeaderSize + before.size();
+    damaged.replace(middle, 5, "\xFF\xFF\xFF\xFF\x0F");
+    {
+        std::ofstream file(path + ".games", std::ios::binary | std::ios::trunc);
+        file << damaged;
+    }
+
+    // Only the damaged record is lost, however the log is split for
+    // parsing, and the file is left as it is.
+    for (const int threads : {1, 4}) {
+        DatabaseManager db(path);
+        db.setLoadThreads(threads);
+        const std::vector<GameState> loaded = db.loadGameHistory();
+        QCOMPARE(loaded.size(), games.size() - 1);
+        QCOMPARE(loaded[19999].gameId, std::string("game-19999"));
+        QCOMPARE(loaded[20000].gameId, std::string("game-20001"));
+        QCOMPARE(loaded.back().gameId, std::string("game-39999"));
+        QCOMPARE(db.getGameLogStats().truncatedBytes, size_t(0));
+        QCOMPARE(std::filesystem::file_size(path + ".games"), damaged.size());
+    }
+}
+
+void TestSuite::testGameLogCompaction() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    DatabaseManager db(path);
+    // Re-appending a game id supersedes the earlier record.
+    for (int i = 0; i < 200; ++i) {
+        GameState game = makeTestGame("game-a");
+        game.durationSeconds = i;
+        game.result = (i % 2 == 0) ? GameResult::DRAW : GameResult::O_WINS;
+        QVERIFY(db.appendGame(game));
+    }
+    const auto logSize = std::filesystem::file_size(path + ".games");
+
+    std::vector<GameState> games = db.loadGameHistory();
+    QCOMPARE(games.size(), size_t(1));
+    QCOMPARE(games[0].result, GameResult::O_WINS);
+    // Loading found 199 dead records, which is enough to compact the log.
+    QCOMPARE(db.getGameLogStats().deadRecords, size_t(0));
+    QVERIFY(std::filesystem::file_size(path + ".games") * 100 < logSize);
+    QCOMPARE(db.loadGameHistory().size(), size_t(1));
+}
+
+void TestSuite::testUserStoreUpdatesInPlace() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    std::unordered_map<std::string, UserProfile> users;
+    for (int i = 0; i < 50; ++i) {
+        UserProfile user;
+        user.userId = "id" + std::to_string(i);
+        user.username = "player" + std::to_string(i);
+        user.passwordHash = std::string(64, 'a');
+        users[user.userId] = user;
+    }
+    DatabaseManager db(path);
+    QVERIFY(db.saveUsers(users));
+    const auto fileSize = std::filesystem::file_size(path + ".users");
+
+    UserProfile updated = users["id7"];
+    updated.gamesPlayed = 12;
+    updated.gamesWon = 9;
+    updated.totalGameTimeSeconds = 123456789012LL;
+    QVERIFY(db.saveUser(updated));
+    // Same record length, so the file is patched rather than grown.
+    QCOMPARE(std::filesystem::file_size(path + ".users"), fileSize);
+
+    auto loaded = DatabaseManager(path).loadUsers();
+    QCOMPARE(loaded.size(), size_t(50));
+    QCOMPARE(loaded["id7"].gamesWon, 9);
+    QCOMPARE(loaded["id7"].totalGameTimeSeconds, 123456789012LL);
+    QCOMPARE(loaded["id8"].username, std::string("player8"));
+    QCOMPARE(loaded["id8"].gamesPlayed, 0);
+}
+
+void TestSuite::testUserStoreMigratesLegacyRecords() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    {
+        std::ofstream file(path + ".users", std::ios::binary);
+        file << "id1|alice|hash1|3|2|1|0|60|2|2|3|0\n"
+             << "id2|bob|hash2|1|0|1|0|30|0|0|0|1\n";
+    }
+    DatabaseManager db(path);
+    auto users = db.loadUsers();
+    QCOMPARE(users["id1"].gamesWon, 2);
+
+    // A renamed user gets a new record; a new user is appended.
+    UserProfile alice = users["id1"];
+    alice.username = "alice-the-great";
+    QVERIFY(db.saveUser(alice));
+    UserProfile carol;
+    carol.userId = "id3";
+    carol.username = "carol";
+    carol.passwordHash = "hash3";
+    QVERIFY(db.saveUser(carol));
+    UserProfile bob = users["id2"];
+    bob.gamesPlayed++;
+    QVERIFY(db.saveUser(bob));
+
+    auto loaded = DatabaseManager(path).loadUsers();
+    QCOMPARE(loaded.size(), size_t(3));
+    QCOMPARE(loaded["id1"].username, std::string("alice-the-great"));
+    QCOMPARE(loaded["id1"].longestWinStreak, 2);
+    QCOMPARE(loaded["id2"].gamesPlayed, 2);
+    QCOMPARE(loaded["id3"].username, std::string("carol"));
+}
+
+void TestSuite::testBinaryGameRecordRoundTrip() {
+    GameState classic = makeTestGame("game-a");
+    classic.durationSeconds = 42;
+    GameState gomoku = makeTestGame("game-b", 15, 5);
+    gomoku.moveHistory = {Move(7, 7), Move(14, 14), Move(0, 13)};
+    gomoku.timestamp = "not a timestamp";
+
+    std::string buffer;
+    record_format::appendGameRecord(buffer, classic);
+    const std::size_t classicSize = buffer.size();
+    record_format::appendGameRecord(buffer, gomoku);
+    // Five classic moves pack into three bytes.
+    QVERIFY(classicSize < 40);
+
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    GameState decoded;
+    QCOMPARE(record_format::readGameRecord(p, end, decoded), record_format::FrameStatus::Ok);
+    QCOMPARE(decoded.timestamp, classic.timestamp);
+    QCOMPARE(decoded.durationSeconds, 42);
+    QCOMPARE(decoded.result, GameResult::X_WINS);
+    QVERIFY(decoded.isAIOpponent);
+    QCOMPARE(decoded.moveHistory.size(), size_t(5));
+    QCOMPARE(decoded.moveHistory[4].col, 2);
+
+    QCOMPARE(record_format::readGameRecord(p, end, decoded), record_format::FrameStatus::Ok);
+    QCOMPARE(decoded.timestamp, std::string("not a timestamp"));
+    QCOMPARE(decoded.boardSize, 15);
+    QCOMPARE(decoded.moveHistory[1].row, 14);
+    QCOMPARE(decoded.moveHistory[2].col, 13);
+    QVERIFY(p == end);
+
+    // Flipping a payload byte fails the checksum; cutting the buffer short
+    // reads as a torn tail.
+    std::string damaged = buffer.substr(0, classicSize);
+    damaged[5] ^= 0x40;
+    p = damaged.data();
+    QCOMPARE(record_format::readGameRecord(p, p + damaged.size(), decoded), record_format::FrameStatus::Corrupt);
+    p = buffer.data();
+    QCOMPARE(record_format::readGameRecord(p, p + classicSize - 1, decoded), record_format::FrameStatus::Truncated);
+}
+
+void TestSuite::testTextHistoryMigratesToBinary() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    {
+        std::ofstream file(path + ".games", std::ios::binary);
+        file << "game-1|u1|AI|1|1|2024-03-01 09:30:00|0,0;1,1;0,1;2,2;0,2\n"
+             << "game-2|u1|Player2|0|3|2024-03-02 10:00:00|7,7;7,8|15,5\n";
+    }
+    DatabaseManager db(path);
+    std::vector<GameState> games = db.loadGameHistory();
+    QCOMPARE(games.size(), size_t(2));
+
+    std::ifstream file(path + ".games", std::ios::binary);
+    char magic[4] = {};
+    file.read(magic, 4);
+    QVERIFY(std::equal(magic, magic + 4, record_format::kGamesMagic));
+
+    QVERIFY(db.appendGame(makeTestGame("game-3")));
+    std::vector<GameState> reloaded = DatabaseManager(path).loadGameHistory();
+    QCOMPARE(reloaded.size(), size_t(3));
+    QCOMPARE(reloaded[0].timestamp, std::string("2024-03-01 09:30:00"));
+    QCOMPARE(reloaded[1].result, GameResult::DRAW);
+    QCOMPARE(reloaded[1].winLength, 5);
+    QCOMPARE(reloaded[1].moveHistory[1].col, 8);
+}
+
+void TestSuite::testMappedGameLogDecodesOnDemand() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    DatabaseManager db(path);
+    QVERIFY(db.appendGame(makeTestGame("game-a")));
+    QVERIFY(db.appendGame(makeTestGame("game-b", 15, 5)));
+    QVERIFY(db.appendGame(makeTestGame("game-c")));
+    const auto recordEnd = std::filesystem::file_size(path + ".games");
+
+    std::shared_ptr<const MappedGameLog> log = db.mapGameHistory();
+    QVERIFY(log != nullptr);
+    QCOMPARE(log->size(), size_t(3));
+    record_format::GameRecordView view;
+    QVERIFY(log->view(1, view));
+    QVERIFY(view.gameId == "game-b");
+    QVERIFY(view.player1Id == "user-1");
+    QCOMPARE(view.boardSize, 15);
+    QCOMPARE(view.moveCount, 5);
+    QCOMPARE(view.move(1).row, 1);
+    QCOMPARE(view.timestamp(), std::string("2024-01-01 12:00:00"));
+
+    GameState game;
+    QVERIFY(log->materialize(2, game));
+    QCOMPARE(game.gameId, std::string("game-c"));
+    QCOMPARE(game.moveHistory.size(), size_t(5));
+
+    // Damage the last byte of the last record: only that record fails.
+    {
+        std::fstream file(path + ".games", std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(recordEnd) - 5);
+        file.put('\x7f');
+    }
+    log = db.mapGameHistory();
+    QCOMPARE(log->size(), size_t(3));
+    QVERIFY(log->view(0, view));
+    QVERIFY(!log->view(2, view));
+
+    // Compacting replaces the file under the mapping, which is reopened on
+    // the new file with its records renumbered.
+    QVERIFY(db.appendGame(makeTestGame("game-a")));
+    const std::uint64_t generation = log->generation();
+    QVERIFY(db.compactGameLog());
+    QVERIFY(log->generation() > generation);
+    QVERIFY(log->isOpen());
+    QCOMPARE(log->size(), size_t(2));
+    QVERIFY(log->view(0, view));
+    QVERIFY(view.gameId == "game-a");
+    QVERIFY(log->view(1, view));
+    QVERIFY(view.gameId == "game-b");
+}
+
+void TestSuite::testGameHistoryReadsFromMappedLog() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    DatabaseManager db(path);
+    for (int i = 0; i < 10; ++i) {
+        GameState game = makeTestGame("game-" + std::to_string(i));
+        game.player1Id = (i % 2 == 0) ? "even" : "odd";
+        game.timestamp = "2024-01-01 12:00:0" + std::to_string(i);
+        QVERIFY(db.appendGame(game));
+    }
+
+    GameHistory history;
+    history.loadFromDatabase(db);
+    QCOMPARE(history.getGameCount(), size_t(10));
+    QVERIFY(history.getRecentGames().empty());
+
+    const GameRange evenGames = history.getUserGames("even");
+    QCOMPARE(evenGames.size(), size_t(5));
+    QCOMPARE(evenGames.front().gameId, std::string("game-8")); // Newest first.
+    QCOMPARE(history.getGameById("game-3")->player1Id, std::string("odd"));
+    QVERIFY(!history.getGameById("game-missing"));
+
+    const std::string newId = history.saveGame("even", "AI", true, {Move(1, 1)}, GameResult::DRAW);
+    QCOMPARE(history.getGameCount(), size_t(11));
+    QCOMPARE(history.getUserGames("even").size(), size_t(6));
+    QCOMPARE(history.replayGame(newId).getCell(1, 1), Player::X);
+    QCOMPARE(history.replayGame("game-4").getCell(0, 2), Player::X);
+}
+
+void TestSuite::testPersistenceWriterCoalescesUpdates() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    DatabaseManager db(path);
+    PersistenceWriter writer(db);
+
+    UserProfile user;
+    user.userId = "id1";
+    user.username = "alice";
+    user.passwordHash = "hash";
+    for (int i = 1; i <= 100; ++i) {
+        user.gamesPlayed = i;
+        writer.saveUser(user);
+        writer.appendGame(makeTestGame("game-" + std::to_string(i)));
+    }
+    writer.flush();
+
+    // Queued far faster than the coalescing window, so the hundred profile
+    // updates collapse into (at most) a couple of writes.
+    const PersistenceWriter::Stats stats = writer.getStats();
+    QVERIFY(stats.userWrites < 100);
+    QCOMPARE(stats.gameWrites, std::uint64_t(100));
+    QCOMPARE(stats.failedWrites, std::uint64_t(0));
+
+    DatabaseManager reader(path);
+    QCOMPARE(reader.loadUsers()["id1"].gamesPlayed, 100);
+    QCOMPARE(reader.loadGameHistory().size(), size_t(100));
+}
+
+void TestSuite::testPersistenceWriterFlushesOnDestruction() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    DatabaseManager db(path);
+    {
+        // A long window: only the destructor's flush can write these.
+        PersistenceWriter writer(db, std::chrono::milliseconds(60000));
+        writer.appendGame(makeTestGame("game-a"));
+        writer.appendGame(makeTestGame("game-b"));
+    }
+    QCOMPARE(DatabaseManager(path).loadGameHistory().size(), size_t(2));
+}
+
+void TestSuite::testUserJournalRepairsTornUpdate() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    UserProfile alice;
+    alice.userId = "id1";
+    alice.username = "alice";
+    alice.passwordHash = "hash";
+    {
+        DatabaseManager db(path);
+        QVERIFY(db.saveUsers({{alice.userId, alice}}));
+        alice.gamesPlayed = 7;
+        alice.gamesWon = 4;
+        QVERIFY(db.saveUser(alice));
+    }
+    QVERIFY(std::filesystem::exists(path + ".users.wal"));
+
+    // Simulate a crash half-way through the in-place write: the stats block
+    // at the end of the record holds garbage.
+    const auto size = std::filesystem::file_size(path + ".users");
+    {
+        std::fstream file(path + ".users", std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(size) - 20);
+        file.write("\xff\xff\xff\xff\xff\xff\xff\xff", 8);
+    }
+
+    DatabaseManager db(path);
+    auto users = db.loadUsers();
+    QCOMPARE(users["id1"].gamesPlayed, 7);
+    QCOMPARE(users["id1"].gamesWon, 4);
+    QCOMPARE(users["id1"].longestWinStreak, 0);
+    QCOMPARE(users["id1"].aiGamesPlayed, 0);
+    // Replaying rewrites the store, after which the journal is redundant.
+    QVERIFY(!std::filesystem::exists(path + ".users.wal"));
+    QCOMPARE(DatabaseManager(path).loadUsers()["id1"].gamesWon, 4);
+}
+
+void TestSuite::testAtomicWriteReplacesWholeFile() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("data").toStdString();
+    QVERIFY(durable_file::writeAtomically(path, std::string(4096, 'a')));
+    QVERIFY(durable_file::writeAtomically(path, "short"));
+    QCOMPARE(std::filesystem::file_size(path), std::uintmax_t(5));
+    QVERIFY(!std::filesystem::exists(path + ".tmp"));
+
+    QVERIFY(durable_file::append(path, "+tail"));
+    std::ifstream file(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    QCOMPARE(contents, std::string("short+tail"));
+
+    // A failed write (no such directory) reports failure.
+    QVERIFY(!durable_file::writeAtomically(dir.filePath("missing/data").toStdString(), "x"));
+
+    // So does a rename that can't replace the target, which is kept.
+    const std::string busy = dir.filePath("busy").toStdString();
+    std::filesystem::create_directories(busy + "/inside");
+    QVERIFY(!durable_file::writeAtomically(busy, "x"));
+    QVERIFY(std::filesystem::is_directory(busy + "/inside"));
+    QVERIFY(!std::filesystem::exists(busy + ".tmp"));
+}
+
+void TestSuite::testSqliteEngineIndexedQueries() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    {
+        std::unique_ptr<StorageBackend> db = openStorage(StorageKind::SQLite, path);
+        QVERIFY(db != nullptr);
+        QVERIFY(db->hasIndexedLookups());
+        db->setSyncWrites(false);
+        std::vector<GameState> games;
+        for (int i = 0; i < 6; ++i) {
+            games.push_back(makeTestGame("game-" + std::to_string(i)));
+            games.back().player1Id = (i % 2 == 0) ? "even" : "odd";
+            games.back().timestamp = "2024-01-01 12:00:0" + std::to_string(i);
+        }
+        games.push_back(makeTestGame("game-big", 15, 5));
+        games.back().player2Id = "even";
+        games.back().moveHistory = {Move(14, 14), Move(7, 7)};
+        QVERIFY(db->appendGames(games));
+
+        // Saving a game again replaces it without moving it.
+        GameState replay = games[1];
+        replay.result = GameResult::DRAW;
+        QVERIFY(db->appendGame(replay));
+
+        UserProfile alice;
+        alice.userId = "id1";
+        alice.username = "alice";
+        alice.passwordHash = "hash";
+        alice.totalGameTimeSeconds = 1LL << 40;
+        QVERIFY(db->writeBatch({{alice.userId, alice}}, {}));
+    }
+
+    std::unique_ptr<StorageBackend> db = openStorage(StorageKind::SQLite, path);
+    QCOMPARE(db->countGames(), size_t(7));
+    std::vector<GameState> all = db->loadGameHistory();
+    QCOMPARE(all.size(), size_t(7));
+    QCOMPARE(all[1].gameId, std::string("game-1"));
+    QCOMPARE(all[1].result, GameResult::DRAW);
+
+    std::vector<GameState> evenGames = db->loadUserGames("even");
+    QCOMPARE(evenGames.size(), size_t(4));
+    QCOMPARE(evenGames[0].gameId, std::string("game-4")); // Newest first.
+    // Same timestamp as game-0, but saved after it.
+    QCOMPARE(evenGames[2].gameId, std::string("game-big"));
+    QCOMPARE(evenGames[3].gameId, std::string("game-0"));
+
+    GameState big;
+    QVERIFY(db->loadGame("game-big", big));
+    QCOMPARE(big.boardSize, 15);
+    QCOMPARE(big.moveHistory.size(), size_t(2));
+    QCOMPARE(big.moveHistory[0].row, 14);
+    QCOMPARE(big.moveHistory[1].col, 7);
+    QVERIFY(!db->loadGame("game-missing", big));
+
+    UserProfile alice;
+    QVERIFY(db->loadUser("id1", alice));
+    QCOMPARE(alice.username, std::string("alice"));
+    QCOMPARE(alice.totalGameTimeSeconds, 1LL << 40);
+
+    // GameHistory queries the database instead of loading it, and merges
+    // in games saved this session.
+    GameHistory history;
+    history.loadFromDatabase(*db);
+    QVERIFY(history.getRecentGames().empty());
+    history.saveGame("odd", "AI", true, {Move(1, 1)}, GameResult::DRAW);
+    QCOMPARE(history.getGameCount(), size_t(8));
+    QCOMPARE(history.getUserGames("odd").size(), size_t(4));
+    QCOMPARE(history.getGameById("game-3")->player1Id, std::string("odd"));
+    QVERIFY(db->appendGame(history.getRecentGames().back()));
+    QCOMPARE(history.getGameCount(), size_t(8));
+    QCOMPARE(history.getUserGames("odd").size(), size_t(4));
+
+    // A writer thread's connection is closed when the thread exits, and a
+    // later writer (which may get the same thread id) opens a new one.
+    const std::size_t connections = QSqlDatabase::connectionNames().size();
+    for (int i = 0; i < 2; ++i) {
+        {
+            PersistenceWriter writer(*db);
+            writer.appendGame(makeTestGame("game-writer-" + std::to_string(i)));
+            writer.flush();
+            QCOMPARE(QSqlDatabase::connectionNames().size(), connections + 1);
+        }
+        QCOMPARE(QSqlDatabase::connectionNames().size(), connections);
+    }
+    QCOMPARE(db->countGames(), size_t(10));
+}
+
+void TestSuite::testSqliteEngineImportsFlatFiles() {
+    QTemporaryDir dir;
+    const std::string path = dir.filePath("db").toStdString();
+    UserProfile alice;
+    alice.userId = "id1";
+    alice.username = "alice";
+    alice.passwordHash = "hash";
+    alice.gamesWon = 3;
+    {
+        // Text files with a journal entry and a torn tail, all of which a
+        // normal load would rewrite.
+        DatabaseManager flat(path);
+        flat.setStorageFormat(DatabaseManager::StorageFormat::Text);
+        alice.gamesWon = 2;
+        QVERIFY(flat.saveUsers({{alice.userId, alice}}));
+        alice.gamesWon = 3;
+        QVERIFY(flat.saveUser(alice));
+        QVERIFY(flat.appendGame(makeTestGame("game-a")));
+        QVERIFY(flat.appendGame(makeTestGame("game-b")));
+        QVERIFY(durable_file::append(path + ".games", "torn"));
+    }
+    auto readAll = [](const std::string& file) {
+        std::ifstream in(file, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    };
+    const std::string users = readAll(path + ".users");
+    const std::string journal = readAll(path + ".users.wal");
+    const std::string games = readAll(path + ".games");
+    QVERIFY(!journal.empty());
+    {
+        std::unique_ptr<StorageBackend> db = openStorage(StorageKind::SQLite, path);
+        QCOMPARE(db->loadUsers()["id1"].gamesWon, 3);
+        QCOMPARE(db->countGames(), size_t(2));
+        QVERIFY(db->appendGame(makeTestGame("game-c")));
+    }
+    // The import leaves the flat files exactly as they were.
+    QCOMPARE(readAll(path + ".users"), users);
+    QCOMPARE(readAll(path + ".users.wal"), journal);
+    QCOMPARE(readAll(path + ".games"), games);
+    // Imported once: the flat files are no longer written to or read.
+    QCOMPARE(DatabaseManager(path).loadGameHistory().size(), size_t(2));
+    QCOMPARE(openStorage(StorageKind::SQLite, path)->countGames(), size_t(3));
+}
+
+void TestSuite::testStorageBackendsAgree() {
+    QTemporaryDir dir;
+    UserProfile alice;
+    alice.userId = "id1";
+    alice.username = "alice";
+    alice.passwordHash = "hash";
+    std::vector<GameState> games;
+    for (int i = 0; i < 4; ++i) {
+        games.push_back(makeTestGame("game-" + std::to_string(i)));
+        games.back().player2Id = (i % 2 == 0) ? "id1" : "AI";
+        games.back().timestamp = "2024-01-01 12:00:0" + std::to_string(i);
+    }
+    // Saved later within the same second as game-0.
+    for (int i = 4; i < 6; ++i) {
+        games.push_back(makeTestGame("game-" + std::to_string(i)));
+        games.back().player2Id = "id1";
+        games.back().timestamp = games[0].timestamp;
+    }
+
+    for (const StorageKind kind : {StorageKind::FlatText, StorageKind::BinaryLog, StorageKind::SQLite,
+                                   StorageKind::InMemory}) {
+        StorageKind parsed;
+        QVERIFY(parseStorageKind(storageKindName(kind), parsed));
+        QVERIFY(parsed == kind);
+        std::unique_ptr<StorageBackend> storage =
+            openStorage(kind, dir.filePath(storageKindName(kind)).toStdString());
+        QVERIFY(storage != nullptr);
+        storage->setSyncWrites(false);
+
+        QVERIFY(storage->saveUsers({{alice.userId, alice}}));
+        alice.gamesWon = 2;
+        QVERIFY(storage->writeBatch({{alice.userId, alice}}, games));
+        alice.gamesWon = 0;
+        UserProfile loaded;
+        QVERIFY(storage->loadUser("id1", loaded));
+        QCOMPARE(loaded.gamesWon, 2);
+        QVERIFY(!storage->loadUser("nobody", loaded));
+
+        QCOMPARE(storage->countGames(), size_t(6));
+        std::vector<std::string> userGames;
+        for (const auto& stored : storage->loadUserGames("id1")) {
+            userGames.push_back(stored.gameId);
+        }
+        QCOMPARE(userGames, (std::vector<std::string>{"game-2", "game-5", "game-4", "game-0"}));
+        GameState game;
+        QVERIFY(storage->loadGame("game-3", game));
+        QCOMPARE(game.moveHistory.size(), size_t(5));
+        std::vector<std::string> streamed;
+        storage->forEachGame([&](const GameState& stored) {
+            streamed.push_back(stored.gameId);
+            return true;
+        });
+        QCOMPARE(streamed, (std::vector<std::string>{"game-0", "game-1", "game-2", "game-3", "game-4", "game-5"}));
+
+        QVERIFY(storage->saveGameHistory({games[3]}));
+        QCOMPARE(storage->loadGameHistory().size(), size_t(1));
+        QVERIFY(storage->loadUserGames("id1").empty());
+    }
+    StorageKind unknown;
+    QVERIFY(!parseStorageKind("floppy", unknown));
+}
+
+void TestSuite::testStreamingReaderSpansChunks() {
+    QTemporaryDir dir;
+    for (const auto format : {DatabaseManager::StorageFormat::Text, DatabaseManager::StorageFormat::Binary}) {
+        const std::string path = dir.filePath(format == DatabaseManager::StorageFormat::Text ? "text" : "binary")
+                                     .toStdString();
+        DatabaseManager db(path);
+        db.setStorageFormat(format);
+        db.setSyncWrites(false);
+        // Large enough that records straddle the reader's chunk boundaries.
+        std::vector<GameState> games;
+        for (int i = 0; i < 3000; ++i) {
+            games.push_back(makeTestGame("game-" + std::to_string(i)));
+        }
+        QVERIFY(db.appendGames(games));
+        {
+            std::ofstream torn(path + ".games", std::ios::binary | std::ios::app);
+            torn << "\x05game-";
+        }
+        const auto size = std::filesystem::file_size(path + ".games");
+
+        std::size_t visited = 0;
+        std::size_t intact = 0;
+        std::string last;
+        db.forEachGame([&](const GameState& game) {
+            visited++;
+            intact += game.moveHistory.size() == 5;
+            last = game.gameId;
+            return true;
+        });
+        QCOMPARE(visited, size_t(3000));
+        QCOMPARE(intact, size_t(3000));
+        QCOMPARE(last, std::string("game-2999"));
+        QCOMPARE(std::filesystem::file_size(path + ".games"), size);
+
+        visited = 0;
+        db.forEachGame([&](const GameState&) { return ++visited < 10; });
+        QCOMPARE(visited, size_t(10));
+    }
+
+    // A length prefix damaged in the middle of the log is skipped over
+    // rather than waited for: only that record is lost.
+    {
+        const std::string path = dir.filePath("damaged").toStdString();
+        DatabaseManager db(path);
+        db.setSyncWrites(false);
+        std::vector<GameState> games;
+        std::string before;
+        for (int i = 0; i < 3000; ++i) {
+            games.push_back(makeTestGame("game-" + std::to_string(i)));
+            if (i < 1500) {
+                record_format::appendGameRecord(before, games.back());
+            }
+        }
+        QVERIFY(db.saveGameHistory(games));
+        std::fstream file(path + ".games", std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(record_format::kHeaderSize + before.size()));
+        file.write("\xFF\xFF\xFF\xFF\x0F", 5);
+        file.close();
+
+        std::vector<std::string> ids;
+        db.forEachGame([&](const GameState& game) {
+            ids.push_back(game.gameId);
+            return true;
+        });
+        QCOMPARE(ids.size(), size_t(2999));
+        QCOMPARE(ids[1499], std::string("game-1499"));
+        QCOMPARE(ids[1500], std::string("game-1501"));
+        QCOMPARE(ids.back(), std::string("game-2999"));
+
+        MappedGameLog mapped;
+        QVERIFY(mapped.open(path + ".games"));
+        QCOMPARE(mapped.size(), size_t(2999));
+        QVERIFY(!mapped.hasTornTail());
+    }
+
+    // An append after a torn text line loses only the fragment.
+    DatabaseManager db(dir.filePath("text").toStdString());
+    db.setStorageFormat(DatabaseManager::StorageFormat::Text);
+    QVERIFY(db.appendGame(makeTestGame("game-new")));
+    std::vector<GameState> games = db.loadGameHistory();
+    QCOMPARE(games.size(), size_t(3001));
+    QCOMPARE(games.back().gameId, std::string("game-new"));
+}
+
+void TestSuite::testGameHistoryLoadsRecentGamesEagerly() {
+    QTemporaryDir dir;
+    DatabaseManager db(dir.filePath("db").toStdString());
+    db.setStorageFormat(DatabaseManager::StorageFormat::Text);
+    for (int i = 0; i < 50; ++i) {
+        GameState game = makeTestGame("game-" + std::to_string(i));
+        game.player1Id = (i % 2 == 0) ? "even" : "odd";
+        QVERIFY(db.appendGame(game));
+    }
+
+    GameHistory history;
+    history.loadFromDatabase(db, 10);
+    QVERIFY(history.getRecentGames().empty());
+    QCOMPARE(history.getGameCount(), size_t(50));
+    // Newer games come from memory (packed until looked up), older ones
+    // from the log.
+    const GameState* eager = history.getGameById("game-45");
+    QCOMPARE(eager->player1Id, std::string("odd"));
+    QCOMPARE(eager->timestamp, std::string("2024-01-01 12:00:00"));
+    QCOMPARE(eager->moveHistory.size(), size_t(5));
+    QCOMPARE(eager->moveHistory[3].col, 2);
+    QCOMPARE(history.getGameById("game-45"), eager);
+    QCOMPARE(history.getGameById("game-2")->player1Id, std::string("even"));
+    QVERIFY(!history.getGameById("game-missing"));
+    QCOMPARE(history.getUserGames("even").size(), size_t(25));
+
+    history.saveGame("even", "AI", true, {Move(1, 1)}, GameResult::DRAW);
+    QCOMPARE(history.getGameCount(), size_t(51));
+    QCOMPARE(history.getUserGames("even").size(), size_t(26));
+
+    // Everything fits: lookups never go back to the log.
+    history.loadFromDatabase(db, 100);
+    QCOMPARE(history.getGameCount(), size_t(50));
+    QCOMPARE(history.getUserGames("odd").size(), size_t(25));
+
+    // The load pass notes each user's records, so a user's first lookup
+    // streams only up to their last one, and not at all if it is held.
+    StreamOnlyStore store;
+    for (int i = 0; i < 50; ++i) {
+        GameState game = makeTestGame("game-" + std::to_string(i));
+        game.player1Id = (i < 3) ? "early" : (i == 30) ? "middle" : (i == 45) ? "recent" : "late";
+        QVERIFY(store.appendGame(game));
+    }
+    history.loadFromDatabase(store, 10);
+    store.streamed = 0;
+    QCOMPARE(history.getUserGames("early").size(), size_t(3));
+    QCOMPARE(store.streamed, size_t(3));
+    store.streamed = 0;
+    QCOMPARE(history.getUserGames("middle").size(), size_t(1));
+    QCOMPARE(store.streamed, size_t(31));
+    store.streamed = 0;
+    QCOMPARE(history.getUserGames("AI").size(), size_t(50));
+    QCOMPARE(store.streamed, size_t(40));
+    store.streamed = 0;
+    QCOMPARE(history.getUserGames("recent").size(), size_t(1));
+    QCOMPARE(history.getUserGames("nobody").size(), size_t(0));
+    QCOMPARE(store.streamed, size_t(0));
+}
+
+void TestSuite::testParallelLoadMatchesSequential() {
+    QTemporaryDir dir;
+    for (const auto format : {DatabaseManager::StorageFormat::Text, DatabaseManager::StorageFormat::Binary}) {
+        const std::string path = dir.filePath(format == DatabaseManager::StorageFormat::Text ? "text" : "binary")
+                                     .toStdString();
+        {
+            DatabaseManager db(path);
+            db.setStorageFormat(format);
+            db.setSyncWrites(false);
+            // Past the size at which loading goes parallel.
+            std::vector<GameState> games;
+            for (int i = 0; i < 40000; ++i) {
+                games.push_back(makeTestGame("game-" + std::to_string(i)));
+            }
+            QVERIFY(db.appendGames(games));
+            GameState replaced = makeTestGame("game-7");
+            replaced.timestamp = "2024-02-02 08:00:00";
+            QVERIFY(db.appendGame(replaced));
+        }
+        {
+            std::ofstream file(path + ".games", std::ios::binary | std::ios::app);
+            if (format == DatabaseManager::StorageFormat::Text) {
+                file << "not a record\t00000000\n";
+            }
+            file << "\x05game-";
+        }
+        std::filesystem::copy_file(path + ".games", path + "-parallel.games");
+
+        DatabaseManager sequential(path);
+        sequential.setStorageFormat(format);
+        sequential.setLoadThreads(1);
+        DatabaseManager parallel(path + "-parallel");
+        parallel.setStorageFormat(format);
+        parallel.setLoadThreads(4);
+        const std::vector<GameState> expected = sequential.loadGameHistory();
+        const std::vector<GameState> actual = parallel.loadGameHistory();
+
+        QCOMPARE(actual.size(), size_t(40000));
+        QCOMPARE(actual.size(), expected.size());
+        std::size_t matching = 0;
+        for (std::size_t i = 0; i < actual.size(); ++i) {
+            matching += actual[i].gameId == expected[i].gameId &&
+                        actual[i].timestamp == expected[i].timestamp &&
+                        actual[i].moveHistory.size() == expected[i].moveHistory.size();
+        }
+        QCOMPARE(matching, actual.size());
+        QCOMPARE(actual[7].timestamp, std::string("2024-02-02 08:00:00"));
+        QCOMPARE(parallel.getGameLogStats().deadRecords, sequential.getGameLogStats().deadRecords);
+        QCOMPARE(parallel.getGameLogStats().truncatedBytes, sequential.getGameLogStats().truncatedBytes);
+        QCOMPARE(std::filesystem::file_size(path + "-parallel.games"), std::filesystem::file_size(path + ".games"));
+    }
+}
+
+void TestSuite::testUserGamesIndexedByTime() {
+    QTemporaryDir dir;
+    DatabaseManager db(dir.filePath("db").toStdString());
+    db.setStorageFormat(DatabaseManager::StorageFormat::Text);
+    // Stored out of time order.
+    const int minutes[] = {30, 10, 50, 20, 40};
+    for (int i = 0; i < 5; ++i) {
+        GameState game = makeTestGame("game-" + std::to_string(i));
+        game.player2Id = (i % 2 == 0) ? "user-2" : "AI";
+        game.timestamp = "2024-01-01 12:" + std::to_string(minutes[i]) + ":00";
+        QVERIFY(db.appendGame(game));
+    }
+
+    GameHistory history;
+    history.loadFromDatabase(db);
+    const GameRange games = history.getUserGames("user-1");
+    QCOMPARE(games.size(), size_t(5));
+    const char* expected[] = {"game-2", "game-4", "game-0", "game-3", "game-1"};
+    std::size_t index = 0;
+    for (const GameState& game : games) {
+        QCOMPARE(game.gameId, std::string(expected[index++]));
+    }
+    QCOMPARE(history.getUserGames("user-2").size(), size_t(3));
+    QCOMPARE(history.getUserGames("user-2").front().gameId, std::string("game-2"));
+    QVERIFY(history.getUserGames("nobody").empty());
+
+    // A new game goes to the front of both players' views, which refer to
+    // the history's own copy.
+    history.saveGame("user-1", "user-2", false, {Move(1, 1)}, GameResult::DRAW);
+    const GameState& saved = history.getRecentGames().back();
+    QCOMPARE(&history.getUserGames("user-1")[0], &saved);
+    QCOMPARE(&history.getUserGames("user-2").front(), &saved);
+    QCOMPARE(history.getUserGames("user-1")[5].gameId, std::string("game-1"));
+
+    // A range made before saving still shows the games it had, even once
+    // the list behind it has grown and been reallocated.
+    for (int i = 0; i < 100; ++i) {
+        history.saveGame("user-1", "AI", true, {Move(0, 0)}, GameResult::X_WINS);
+    }
+    QVERIFY(games.isValid());
+    QCOMPARE(games.size(), size_t(5));
+    QCOMPARE(games.front().gameId, std::string("game-2"));
+    QCOMPARE(games[4].gameId, std::string("game-1"));
+
+    // Loading the history again invalidates it rather than leaving it
+    // pointing at games that have gone, as does destroying the history.
+    history.loadFromDatabase(db);
+    QVERIFY(!games.isValid());
+    QVERIFY(games.empty());
+    QVERIFY(games.begin() == games.end());
+    GameRange orphan;
+    {
+        GameHistory other;
+        other.loadFromDatabase(db);
+        orphan = other.getUserGames("user-1");
+        QCOMPARE(orphan.size(), size_t(5));
+    }
+    QVERIFY(orphan.empty());
+}
+
+void TestSuite::testGameByIdUsesHashIndex() {
+    QTemporaryDir dir;
+    DatabaseManager db(dir.filePath("db").toStdString());
+    db.setStorageFormat(DatabaseManager::StorageFormat::Text);
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(db.appendGame(makeTestGame("game-" + std::to_string(i))));
+    }
+    // A later record of game-18 supersedes the first.
+    GameState replaced = makeTestGame("game-18");
+    replaced.player2Id = "user-2";
+    QVERIFY(db.appendGame(replaced));
+
+    GameHistory history;
+    history.loadFromDatabase(db, 5);
+    const GameState* recent = history.getGameById("game-18");
+    QVERIFY(recent);
+    QCOMPARE(recent->player2Id, std::string("user-2"));
+    QCOMPARE(history.getGameById("game-18"), recent);
+    QCOMPARE(history.getUserGames("user-1").size(), size_t(20));
+    QCOMPARE(history.getUserGames("user-2").size(), size_t(1));
+
+    // An older game is read from the log once, then held like the others.
+    const GameState* older = history.getGameById("game-3");
+    QVERIFY(older);
+    QCOMPARE(history.getGameById("game-3"), older);
+    QCOMPARE(history.getUserGames("user-1").size(), size_t(20));
+
+    const std::string newId = history.saveGame("user-1", "AI", true, {Move(1, 1)}, GameResult::DRAW);
+    QCOMPARE(history.getGameById(newId), &history.getRecentGames().back());
+    QCOMPARE(history.getGameById("game-3"), older);
+    QVERIFY(!history.getGameById("game-missing"));
+
+    // A mapped binary log finds older games through the same id index,
+    // taking the newest record of a game saved twice.
+    DatabaseManager binary(dir.filePath("binary").toStdString());
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(binary.appendGame(makeTestGame("game-" + std::to_string(i))));
+    }
+    GameState again = makeTestGame("game-4");
+    again.player2Id = "user-2";
+    QVERIFY(binary.appendGame(again));
+    GameHistory mapped;
+    mapped.loadFromDatabase(binary);
+    const GameState* archived = mapped.getGameById("game-4");
+    QVERIFY(archived);
+    QCOMPARE(archived->player2Id, std::string("user-2"));
+    QVERIFY(mapped.getGameById("game-17"));
+    QVERIFY(!mapped.getGameById("game-missing"));
+
+    // A stream is read only up to the game's record, and a missing id or a
+    // game in the eager window doesn't touch it at all.
+    StreamOnlyStore store;
+    for (int i = 0; i < 20; ++i) {
+        QVERIFY(store.appendGame(makeTestGame("game-" + std::to_string(i))));
+    }
+    GameHistory streamed;
+    streamed.loadFromDatabase(store, 5);
+    store.streamed = 0;
+    QVERIFY(!streamed.getGameById("game-missing"));
+    QVERIFY(streamed.getGameById("game-17"));
+    QCOMPARE(store.streamed, size_t(0));
+    QVERIFY(streamed.getGameById("game-6"));
+    QCOMPARE(store.streamed, size_t(7));
+}
+
+void TestSuite::testHistoryModelFetchesLazily() {
+    GameHistory history;
+    const int total = 2 * GameHistoryModel::kFetchBatch + 50;
+    for (int i = 0; i < total; ++i) {
+        history.saveGame("user-1", (i % 4 == 0) ? "user-2" : "AI", i % 4 != 0,
+                         std::vector<Move>(1 + i % 7, Move(0, 0)), (i % 2 == 0) ? GameResult::DRAW : GameResult::X_WINS);
+    }
+    GameHistoryModel model;
+    model.setGames(history.getUserGames("user-1"));
+    QCOMPARE(model.rowCount(), GameHistoryModel::kFetchBatch);
+    QCOMPARE(model.columnCount(), int(GameHistoryModel::ColumnCount));
+    QVERIFY(model.canFetchMore(QModelIndex()));
+    model.fetchMore(QModelIndex());
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), total);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    // Newest first by default, straight from the index.
+    QCOMPARE(model.gameAt(model.index(0, 0)), &history.getRecentGames().back());
+    QCOMPARE(model.data(model.index(0, GameHistoryModel::DateColumn), GameHistoryModel::GameIdRole)
+                 .toString().toStdString(),
+             history.getRecentGames().back().gameId);
+
+    model.sort(GameHistoryModel::MovesColumn, Qt::DescendingOrder);
+    QCOMPARE(model.rowCount(), GameHistoryModel::kFetchBatch);
+    QCOMPARE(model.data(model.index(0, GameHistoryModel::MovesColumn)).toInt(), 7);
+    model.sort(GameHistoryModel::DateColumn, Qt::AscendingOrder);
+    QCOMPARE(model.gameAt(model.index(0, 0)), &history.getRecentGames().front());
+
+    // One game in four is against user-2; the filter ignores case.
+    model.setFilterText("USER-2");
+    model.fetchMore(QModelIndex());
+    QCOMPARE(model.rowCount(), (total + 3) / 4);
+    QVERIFY(!model.canFetchMore(QModelIndex()));
+    model.setFilterText("draw");
+    QCOMPARE(model.data(model.index(0, GameHistoryModel::ResultColumn)).toString().toStdString(),
+             std::string("It's a Draw"));
+    model.setFilterText("");
+    QCOMPARE(model.rowCount(), GameHistoryModel::kFetchBatch);
+}
+
+void TestSuite::testReplayCursorScrubs() {
+    // A long game on the largest board, played in a fixed scattered order
+    // until it is decided.
+    GameState game = makeTestGame("game-long", GameLogic::kMaxBoardSize, 5);
+    game.moveHistory.clear();
+    GameLogic played(GameLogic::kMaxBoardSize, 5);
+    for (int i = 0; i < GameLogic::kMaxCellCount && played.checkGameResult() == GameResult::IN_PROGRESS; ++i) {
+        const int cell = (i * 13) % GameLogic::kMaxCellCount;
+        const Move move(cell / GameLogic::kMaxBoardSize, cell % GameLogic::kMaxBoardSize);
+        QVERIFY(played.makeMove(move.row, move.col));
+        game.moveHistory.push_back(move);
+    }
+    QVERIFY(game.moveHistory.size() > 200);
+    game.moveHistory.push_back(game.moveHistory.front()); // Illegal: dropped.
+
+    ReplayCursor cursor(game);
+    QCOMPARE(cursor.getBoardSize(), GameLogic::kMaxBoardSize);
+    QCOMPARE(cursor.getMoveCount(), static_cast<int>(game.moveHistory.size()) - 1);
+    QCOMPARE(cursor.getPosition(), 0);
+    QVERIFY(!cursor.previous());
+
+    // Every position matches a from-scratch replay, in any order.
+    std::size_t mismatches = 0;
+    auto check = [&](int ply) {
+        GameLogic expected(GameLogic::kMaxBoardSize, 5);
+        for (int i = 0; i < ply; ++i) {
+            expected.makeMove(game.moveHistory[i].row, game.moveHistory[i].col);
+        }
+        for (int row = 0; row < GameLogic::kMaxBoardSize; ++row) {
+            for (int col = 0; col < GameLogic::kMaxBoardSize; ++col) {
+                mismatches += cursor.getCell(row, col) != expected.getCell(row, col);
+            }
+        }
+        mismatches += cursor.getResult() != expected.checkGameResult();
+    };
+    const int last = cursor.getMoveCount();
+    for (const int ply : {last, 3, last - 1, 0, last / 2}) {
+        cursor.seek(ply);
+        QCOMPARE(cursor.getPosition(), ply);
+        check(ply);
+    }
+    QVERIFY(cursor.next());
+    check(last / 2 + 1);
+    QVERIFY(cursor.previous());
+    QVERIFY(cursor.previous());
+    check(last / 2 - 1);
+    QCOMPARE(mismatches, size_t(0));
+
+    cursor.seek(last + 10);
+    QCOMPARE(cursor.getPosition(), last);
+    QVERIFY(!cursor.next());
+    QCOMPARE(cursor.getResult(), played.checkGameResult());
+
+    GameHistory history;
+    const std::string id = history.saveGame("user-1", "AI", true, game.moveHistory, played.checkGameResult(),
+                                            GameLogic::kMaxBoardSize, 5);
+    QCOMPARE(history.openReplay(id).getMoveCount(), last);
+    QCOMPARE(history.openReplay("game-missing").getMoveCount(), 0);
+}
+
+void TestSuite::testCompactGameStoreRoundTrips() {
+    // Ids and timestamps that pack, and ones that have to be interned: an
+    // id with leading zeros, one that isn't hex, one with uppercase digits,
+    // and a date that doesn't exist.
+    std::vector<GameState> games(5);
+    const char* ids[] = {"game-1a2b3c", "game-000f", "game-big", "game-ABC", "legacy"};
+    const char* times[] = {"2024-03-05 07:08:09", "1969-12-31 23:59:59", "2024-02-30 10:00:00",
+                           "not a time", "2000-02-29 00:00:00"};
+    for (int i = 0; i < 5; ++i) {
+        games[i].gameId = ids[i];
+        games[i].player1Id = "user-" + std::to_string(i % 2);
+        games[i].player2Id = (i % 2) ? "AI" : "Player2";
+        games[i].isAIOpponent = (i % 2) != 0;
+        games[i].result = static_cast<GameResult>(i % 4);
+        games[i].durationSeconds = 60 * i;
+        games[i].timestamp = times[i];
+        games[i].moveHistory = {Move(1, 1), Move(0, 2), Move(2, 0)};
+    }
+    // A 15x15 game is too long for the inline buffer and spills.
+    games[4].boardSize = GameLogic::kMaxBoardSize;
+    games[4].winLength = 5;
+    games[4].moveHistory.clear();
+    for (int m = 0; m < 20; ++m) {
+        games[4].moveHistory.emplace_back(m % 15, (m * 7) % 15);
+    }
+
+    CompactGameStore store;
+    for (const auto& game : games) {
+        store.append(game);
+    }
+    QCOMPARE(store.size(), games.size());
+    auto sameGame = [](const GameState& a, const GameState& b) {
+        return a.gameId == b.gameId && a.player1Id == b.player1Id && a.player2Id == b.player2Id &&
+               a.isAIOpponent == b.isAIOpponent && a.result == b.result && a.durationSeconds == b.durationSeconds &&
+               a.timestamp == b.timestamp && a.boardSize == b.boardSize && a.winLength == b.winLength &&
+               std::equal(a.moveHistory.begin(), a.moveHistory.end(), b.moveHistory.begin(), b.moveHistory.end(),
+                          [](const Move& m, const Move& n) { return m.row == n.row && m.col == n.col; });
+    };
+    GameState copy;
+    for (std::size_t slot = 0; slot < games.size(); ++slot) {
+        store.get(slot, copy);
+        QVERIFY2(sameGame(copy, games[slot]), games[slot].gameId.c_str());
+    }
+
+    // Keys find the slot's game and nothing else.
+    std::uint64_t gameKey;
+    QVERIFY(store.findGameKey("game-000f", gameKey));
+    QCOMPARE(gameKey, store.gameKey(1));
+    QVERIFY(store.findGameKey("legacy", gameKey));
+    QCOMPARE(gameKey, store.gameKey(4));
+    QVERIFY(!store.findGameKey("missing", gameKey));
+    std::uint32_t playerKey;
+    QVERIFY(store.findPlayerKey("user-1", playerKey));
+    QCOMPARE(playerKey, store.player1Key(3));
+    QVERIFY(!store.findPlayerKey("user-9", playerKey));
+
+    GameState replacement = games[4];
+    replacement.result = GameResult::DRAW;
+    replacement.moveHistory.resize(9);
+    store.replace(4, replacement);
+    store.get(4, copy);
+    QVERIFY(sameGame(copy, replacement));
+
+    // Many games with the same players take far less than as GameState.
+    CompactGameStore many;
+    std::size_t gameStateBytes = 0;
+    for (int i = 0; i < 1000; ++i) {
+        GameState game = games[0];
+        game.gameId = "game-" + std::to_string(100000 + i);
+        many.append(game);
+        gameStateBytes += sizeof(GameState) + game.moveHistory.capacity() * sizeof(Move);
+    }
+    QVERIFY(many.memoryBytes() < gameStateBytes / 2);
+
+    // Short strings live in the object itself; long ones are counted.
+    QCOMPARE(CompactGameStore::heapBytes("user-1"), size_t(0));
+    const std::string longText(100, 'x');
+    QVERIFY(CompactGameStore::heapBytes(longText) > longText.size());
+}
+
 void TestSuite::testSuccessfulRegistrationAndLogin() {
     QVERIFY(userAuth.registerUser("testuser", "password123"));
     QVERIFY(userAuth.isLoggedIn());
@@ -106,4 +1715,6 @@ void TestSuite::testFailedLogin() {
 
 // This macro creates the main() function for the test executable
 #include "test_suite.moc"
-QTEST_APPLESS_MAIN(TestSuite)
\ No newline at end of file
+// The SQLite engine's database driver is a plugin, which needs an application
+// object to be loaded.
+QTEST_GUILESS_MAIN(TestSuite)
\ No newline at end of file
@@ -0,0 +1,92 @@
+/*
+================================================================================
+File: tools/generate_perfect_play.cpp
+Purpose: Build-time generator for the 3x3 perfect-play table. It solves
+         every reachable position with a memoized negamax and writes the best
+         cell for each base-3 position code as a C array initializer, which
+         src/perfect_play.cpp then compiles in.
+
+Usage:   generate_perfect_play <output-file>
+================================================================================
+*/
+#include "game_logic.h"
+#include "perfect_play.h"
+#include "search_scoring.h"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// The same move order and scoring as AIEngine, so that among equally good
+// moves the table picks the one the live search would.
+using search_scoring::kMoveOrder;
+using search_scoring::kWinScore;
+
+constexpr int kUnsolved = -2 * kWinScore;
+
+struct Solver {
+    std::vector<int> values = std::vector<int>(perfect_play::kPositionCount, kUnsolved);
+    std::vector<std::int8_t> bestCells = std::vector<std::int8_t>(perfect_play::kPositionCount, -1);
+
+    int code(const GameLogic& game) const {
+        return perfect_play::encode(game.getPlayerBits(Player::X), game.getPlayerBits(Player::O));
+    }
+
+    // Value of the position for the side to move. Also records the best cell.
+    int solve(GameLogic& game) {
+        const int positionCode = code(game);
+        if (values[positionCode] != kUnsolved) {
+            return values[positionCode];
+        }
+
+        int value = 0;
+        GameResult result = game.checkGameResult();
+        if (result == GameResult::IN_PROGRESS) {
+            value = -kWinScore - 1;
+            Bitboard occupied = game.getOccupiedBits();
+            for (int cell : kMoveOrder) {
+                if (occupied & (1u << cell)) continue;
+                game.makeMove(cell / GameLogic::kClassicBoardSize, cell % GameLogic::kClassicBoardSize);
+                int score = -solve(game);
+                game.undoLastMove();
+                if (score > value) {
+                    value = score;
+                    bestCells[positionCode] = static_cast<std::int8_t>(cell);
+                }
+            }
+        } else if (result != GameResult::DRAW) {
+            value = -(kWinScore - static_cast<int>(game.getMoveHistory().size()));
+        }
+
+        values[positionCode] = value;
+        return value;
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <output-file>" << std::endl;
+        return 1;
+    }
+
+    Solver solver;
+    GameLogic game;
+    solver.solve(game); // Solving the empty board reaches every legal position.
+
+    std::ofstream out(argv[1], std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    out << "// Generated by tools/generate_perfect_play.cpp. Do not edit.\n";
+    for (int i = 0; i < perfect_play::kPositionCount; ++i) {
+        out << static_cast<int>(solver.bestCells[i]) << ',';
+        if (i % 27 == 26) out << '\n';
+    }
+    out << '\n';
+    return out.good() ? 0 : 1;
+}